@@ -0,0 +1,467 @@
+/**
+ * @file Algorithm.h
+ * @author Xu.Cao
+ * @details
+ *  本文件提供运行在线程池上的并行算法，适用于随机访问迭代器区间：
+ * - parallelForEach：对每个元素执行函数；
+ * - parallelTransformReduce：先变换再归约，归约操作需要满足结合律；
+ * - parallelInclusiveScan / parallelExclusiveScan：前缀和，操作需要满足结合律；
+ * - parallelCopyIf / parallelPartition：稳定的筛选和划分；
+ * - parallelSort：分块排序后逐轮并行归并（稳定）。
+ *
+ *  区间被切分为连续的块，每块至少 ALGO_GRAIN_MIN 个元素，块数约为工作线程数的数倍，
+ * 每个线程顺序访问一段连续内存。调用线程自己也参与执行（fork-join），
+ * 因此可以在线程池的工作线程中调用；块由执行者动态领取，先空闲的线程多做。
+ * 线程池需要提供 bool post(Task &&) 和 size_t workerNr()，例如 ThreadManager。
+ */
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <exception>
+#include "Task.h"
+#include "Latch.h"
+
+constexpr size_t ALGO_GRAIN_MIN = 4096;      // 每块最少的元素数量
+constexpr size_t ALGO_CHUNKS_PER_WORKER = 4; // 每个工作线程平均分到的块数，用于负载均衡
+
+/**
+ * @class ForkJoin
+ * @brief 一次 fork-join 执行的共享状态
+ *
+ * 帮助任务和调用者从同一个计数器领取块编号，调用者只等待已领取的块执行完成，
+ * 不等待尚未开始的帮助任务；共享状态使用引用计数，最后一个离开的执行者负责释放。
+ */
+template <typename _Fn>
+class ForkJoin final
+{
+    _Fn _M_body;
+    const size_t _M_chunkNr;
+    std::atomic<size_t> _M_next;
+    std::atomic<size_t> _M_refs;
+    std::atomic<bool> _M_failed;
+    std::exception_ptr _M_error;
+    Latch _M_done; // 尚未执行完成的块数量
+
+    ForkJoin(const _Fn &body, size_t chunkNr, size_t refs)
+        : _M_body(body), _M_chunkNr(chunkNr), _M_next(0), _M_refs(refs), _M_failed(false)
+    {
+        _M_done.add(chunkNr);
+    }
+
+    void work()
+    {
+        size_t chunk;
+        while ((chunk = _M_next.fetch_add(1, std::memory_order_relaxed)) < _M_chunkNr)
+        {
+            // 出现异常后剩余的块不再执行，但仍然需要计数
+            if (!_M_failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    _M_body(chunk);
+                }
+                catch (...)
+                {
+                    if (!_M_failed.exchange(true))
+                        _M_error = std::current_exception();
+                }
+            }
+            _M_done.done();
+        }
+    }
+
+    void release()
+    {
+        if (_M_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    static void help(void *arg)
+    {
+        ForkJoin *job = static_cast<ForkJoin *>(arg);
+        job->work();
+        job->release();
+    }
+
+public:
+    /**
+     * @brief 在线程池上执行 body(0) ... body(chunkNr - 1)，阻塞直到全部完成
+     *
+     * 如果某个块抛出异常，剩余的块被跳过，之后在调用线程中重新抛出第一个异常。
+     */
+    template <typename _Manager>
+    static void run(_Manager &manager, size_t chunkNr, const _Fn &body)
+    {
+        if (!chunkNr)
+            return;
+        if (chunkNr == 1)
+        {
+            body(0);
+            return;
+        }
+
+        size_t helperNr = std::min(chunkNr - 1, manager.workerNr());
+        ForkJoin *job = new ForkJoin(body, chunkNr, helperNr + 1);
+        for (size_t i = 0; i < helperNr; i++)
+        {
+            // 线程池不在运行状态时，剩余的块由调用者自己完成
+            if (!manager.post(Task(&ForkJoin::help, job)))
+                job->release();
+        }
+
+        job->work();
+        job->_M_done.wait();
+
+        std::exception_ptr error = job->_M_error;
+        job->release();
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+/**
+ * @class ChunkPlan
+ * @brief 将 [0, size) 切分为连续的块
+ */
+struct ChunkPlan
+{
+    size_t size;
+    size_t grain;
+    size_t chunkNr;
+
+    ChunkPlan(size_t _size, size_t workerNr) : size(_size)
+    {
+        size_t target = (workerNr ? workerNr : 1) * ALGO_CHUNKS_PER_WORKER;
+        grain = std::max(ALGO_GRAIN_MIN, (size + target - 1) / target);
+        chunkNr = (size + grain - 1) / grain;
+    }
+
+    size_t begin(size_t chunk) const { return chunk * grain; }
+    size_t end(size_t chunk) const { return std::min(size, (chunk + 1) * grain); }
+};
+
+template <typename _Manager, typename _Fn>
+void forkJoin(_Manager &manager, size_t chunkNr, const _Fn &body)
+{
+    ForkJoin<_Fn>::run(manager, chunkNr, body);
+}
+
+/* ------------------------------- for_each ------------------------------- */
+
+template <typename _Manager, typename _RandomIt, typename _Fn>
+void parallelForEach(_Manager &manager, _RandomIt first, _RandomIt last, _Fn f)
+{
+    ChunkPlan plan(last - first, manager.workerNr());
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             { std::for_each(first + plan.begin(chunk), first + plan.end(chunk), f); });
+}
+
+/* ---------------------------- transform_reduce ---------------------------- */
+
+template <typename _Manager, typename _RandomIt, typename _Ty, typename _Reduce, typename _Transform>
+_Ty parallelTransformReduce(_Manager &manager, _RandomIt first, _RandomIt last, _Ty init,
+                            _Reduce reduce, _Transform transform)
+{
+    ChunkPlan plan(last - first, manager.workerNr());
+    std::vector<_Ty> partial(plan.chunkNr, init);
+
+    // 每块的部分结果从块的第一个元素开始，不需要单位元
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        _RandomIt it = first + plan.begin(chunk), end = first + plan.end(chunk);
+        _Ty acc = transform(*it);
+        for (++it; it != end; ++it)
+            acc = reduce(acc, transform(*it));
+        partial[chunk] = acc; });
+
+    for (size_t c = 0; c < plan.chunkNr; c++)
+    {
+        init = reduce(init, partial[c]);
+    }
+    return init;
+}
+
+template <typename _Manager, typename _RandomIt, typename _Ty>
+_Ty parallelReduce(_Manager &manager, _RandomIt first, _RandomIt last, _Ty init)
+{
+    using value_type = typename std::iterator_traits<_RandomIt>::value_type;
+    return parallelTransformReduce(manager, first, last, init, std::plus<_Ty>(),
+                                   [](const value_type &x) -> _Ty
+                                   { return x; });
+}
+
+/* --------------------------------- scan --------------------------------- */
+
+/**
+ * @brief 三趟扫描：各块先求和，再串行求出每块的前缀（块数很少），最后各块带前缀扫描
+ *
+ * 输出区间可以与输入区间相同（原地扫描）。
+ */
+template <typename _Manager, typename _RandomIt, typename _OutIt, typename _BinaryOp>
+_OutIt parallelInclusiveScan(_Manager &manager, _RandomIt first, _RandomIt last, _OutIt out, _BinaryOp op)
+{
+    using value_type = typename std::iterator_traits<_RandomIt>::value_type;
+
+    ChunkPlan plan(last - first, manager.workerNr());
+    if (!plan.chunkNr)
+        return out;
+    std::vector<value_type> carry(plan.chunkNr, *first);
+
+    // 只有最后一块的和不会被使用
+    forkJoin(manager, plan.chunkNr - 1, [&](size_t chunk)
+             {
+        _RandomIt it = first + plan.begin(chunk), end = first + plan.end(chunk);
+        value_type acc = *it;
+        for (++it; it != end; ++it)
+            acc = op(acc, *it);
+        carry[chunk] = acc; });
+
+    // carry[c] 变为前 c 块（不含第 c 块）的和，第 0 块没有前缀
+    for (size_t c = plan.chunkNr - 1; c > 0; c--)
+    {
+        carry[c] = carry[c - 1];
+    }
+    for (size_t c = 2; c < plan.chunkNr; c++)
+    {
+        carry[c] = op(carry[c - 1], carry[c]);
+    }
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        size_t i = plan.begin(chunk), end = plan.end(chunk);
+        value_type acc = chunk ? op(carry[chunk], first[i]) : first[i];
+        out[i] = acc;
+        for (++i; i < end; i++)
+        {
+            acc = op(acc, first[i]);
+            out[i] = acc;
+        } });
+
+    return out + plan.size;
+}
+
+template <typename _Manager, typename _RandomIt, typename _OutIt>
+_OutIt parallelInclusiveScan(_Manager &manager, _RandomIt first, _RandomIt last, _OutIt out)
+{
+    using value_type = typename std::iterator_traits<_RandomIt>::value_type;
+    return parallelInclusiveScan(manager, first, last, out, std::plus<value_type>());
+}
+
+template <typename _Manager, typename _RandomIt, typename _OutIt, typename _Ty, typename _BinaryOp>
+_OutIt parallelExclusiveScan(_Manager &manager, _RandomIt first, _RandomIt last, _OutIt out,
+                             _Ty init, _BinaryOp op)
+{
+    ChunkPlan plan(last - first, manager.workerNr());
+    if (!plan.chunkNr)
+        return out;
+    std::vector<_Ty> carry(plan.chunkNr, init);
+
+    forkJoin(manager, plan.chunkNr - 1, [&](size_t chunk)
+             {
+        _RandomIt it = first + plan.begin(chunk), end = first + plan.end(chunk);
+        _Ty acc = *it;
+        for (++it; it != end; ++it)
+            acc = op(acc, *it);
+        carry[chunk + 1] = acc; });
+
+    // carry[c] 变为 init 与前 c 块的和
+    for (size_t c = 1; c < plan.chunkNr; c++)
+    {
+        carry[c] = op(carry[c - 1], carry[c]);
+    }
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        _Ty acc = carry[chunk];
+        for (size_t i = plan.begin(chunk), end = plan.end(chunk); i < end; i++)
+        {
+            // 先读出输入再写入，保证原地扫描正确
+            _Ty x = first[i];
+            out[i] = acc;
+            acc = op(acc, x);
+        } });
+
+    return out + plan.size;
+}
+
+template <typename _Manager, typename _RandomIt, typename _OutIt, typename _Ty>
+_OutIt parallelExclusiveScan(_Manager &manager, _RandomIt first, _RandomIt last, _OutIt out, _Ty init)
+{
+    return parallelExclusiveScan(manager, first, last, out, init, std::plus<_Ty>());
+}
+
+/* --------------------------- copy_if / partition --------------------------- */
+
+/**
+ * @brief 稳定地复制满足 pred 的元素，pred 对每个元素只调用一次
+ * @return _OutIt 输出区间的末尾
+ */
+template <typename _Manager, typename _RandomIt, typename _OutIt, typename _Pred>
+_OutIt parallelCopyIf(_Manager &manager, _RandomIt first, _RandomIt last, _OutIt out, _Pred pred)
+{
+    ChunkPlan plan(last - first, manager.workerNr());
+    std::vector<char> flags(plan.size);
+    std::vector<size_t> offset(plan.chunkNr + 1, 0);
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        size_t kept = 0;
+        for (size_t i = plan.begin(chunk), end = plan.end(chunk); i < end; i++)
+        {
+            flags[i] = pred(first[i]) ? 1 : 0;
+            kept += flags[i];
+        }
+        offset[chunk + 1] = kept; });
+
+    for (size_t c = 0; c < plan.chunkNr; c++)
+    {
+        offset[c + 1] += offset[c];
+    }
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        _OutIt dest = out + offset[chunk];
+        for (size_t i = plan.begin(chunk), end = plan.end(chunk); i < end; i++)
+        {
+            if (flags[i])
+                *dest++ = first[i];
+        } });
+
+    return out + offset[plan.chunkNr];
+}
+
+/**
+ * @brief 稳定划分：满足 pred 的元素移到前面，两部分内部保持原有顺序
+ *
+ * 借助与区间等长的缓冲区完成，元素类型需要可默认构造和移动赋值。
+ * @return _RandomIt 第一个不满足 pred 的元素
+ */
+template <typename _Manager, typename _RandomIt, typename _Pred>
+_RandomIt parallelPartition(_Manager &manager, _RandomIt first, _RandomIt last, _Pred pred)
+{
+    using value_type = typename std::iterator_traits<_RandomIt>::value_type;
+
+    ChunkPlan plan(last - first, manager.workerNr());
+    std::vector<char> flags(plan.size);
+    std::vector<size_t> kept(plan.chunkNr + 1, 0), dropped(plan.chunkNr + 1, 0);
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        size_t nr = 0;
+        for (size_t i = plan.begin(chunk), end = plan.end(chunk); i < end; i++)
+        {
+            flags[i] = pred(first[i]) ? 1 : 0;
+            nr += flags[i];
+        }
+        kept[chunk + 1] = nr;
+        dropped[chunk + 1] = plan.end(chunk) - plan.begin(chunk) - nr; });
+
+    for (size_t c = 0; c < plan.chunkNr; c++)
+    {
+        kept[c + 1] += kept[c];
+        dropped[c + 1] += dropped[c];
+    }
+    size_t point = kept[plan.chunkNr];
+
+    std::vector<value_type> buffer(plan.size);
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             {
+        size_t in = kept[chunk], out = point + dropped[chunk];
+        for (size_t i = plan.begin(chunk), end = plan.end(chunk); i < end; i++)
+        {
+            if (flags[i])
+                buffer[in++] = std::move(first[i]);
+            else
+                buffer[out++] = std::move(first[i]);
+        } });
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             { std::move(buffer.begin() + plan.begin(chunk), buffer.begin() + plan.end(chunk),
+                         first + plan.begin(chunk)); });
+
+    return first + point;
+}
+
+/* --------------------------------- sort --------------------------------- */
+
+// 归并排序的一轮：将 src 中每对相邻的、长度为 width 的有序区间归并到 dst 的相同位置
+template <typename _Manager, typename _SrcIt, typename _DstIt, typename _Compare>
+void parallelMergeRound(_Manager &manager, const ChunkPlan &plan, size_t width,
+                        _SrcIt src, _DstIt dst, _Compare comp)
+{
+    size_t pairNr = (plan.size + 2 * width - 1) / (2 * width);
+    size_t pieceNr = std::max((size_t)1, plan.chunkNr / pairNr);
+
+    forkJoin(manager, pairNr * pieceNr, [&](size_t job)
+             {
+        size_t pair = job / pieceNr, piece = job % pieceNr;
+        size_t lo = pair * 2 * width;
+        size_t mid = std::min(plan.size, lo + width), hi = std::min(plan.size, lo + 2 * width);
+        _SrcIt a = src + lo, b = src + mid;
+        size_t aNr = mid - lo, bNr = hi - mid;
+
+        // 第一段按元素数等分，第二段中严格小于切分元素的部分归入之前的片段，保证稳定
+        size_t aBegin = aNr * piece / pieceNr, aEnd = aNr * (piece + 1) / pieceNr;
+        size_t bBegin = piece ? std::lower_bound(b, b + bNr, a[aBegin], comp) - b : 0;
+        size_t bEnd = piece + 1 < pieceNr ? std::lower_bound(b, b + bNr, a[aEnd], comp) - b : bNr;
+
+        std::merge(std::make_move_iterator(a + aBegin), std::make_move_iterator(a + aEnd),
+                   std::make_move_iterator(b + bBegin), std::make_move_iterator(b + bEnd),
+                   dst + (lo + aBegin + bBegin), comp); });
+}
+
+/**
+ * @brief 稳定的并行归并排序
+ *
+ * 先将各块分别排序，之后每一轮将相邻的两段有序区间归并为一段，在原区间和缓冲区之间交替。
+ * 每对区间的归并再按第一段的等分点切分（第二段用二分查找确定对应的切分点），
+ * 保证即使最后一轮只剩一对区间，也能由所有工作线程共同完成。
+ * 元素类型需要可默认构造和移动赋值。
+ */
+template <typename _Manager, typename _RandomIt, typename _Compare>
+void parallelSort(_Manager &manager, _RandomIt first, _RandomIt last, _Compare comp)
+{
+    using value_type = typename std::iterator_traits<_RandomIt>::value_type;
+
+    ChunkPlan plan(last - first, manager.workerNr());
+    if (plan.chunkNr <= 1)
+    {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+             { std::stable_sort(first + plan.begin(chunk), first + plan.end(chunk), comp); });
+
+    std::vector<value_type> buffer(plan.size);
+    bool inBuffer = false;
+    for (size_t width = plan.grain; width < plan.size; width *= 2)
+    {
+        if (inBuffer)
+            parallelMergeRound(manager, plan, width, buffer.begin(), first, comp);
+        else
+            parallelMergeRound(manager, plan, width, first, buffer.begin(), comp);
+        inBuffer = !inBuffer;
+    }
+
+    if (inBuffer)
+    {
+        forkJoin(manager, plan.chunkNr, [&](size_t chunk)
+                 { std::move(buffer.begin() + plan.begin(chunk), buffer.begin() + plan.end(chunk),
+                             first + plan.begin(chunk)); });
+    }
+}
+
+template <typename _Manager, typename _RandomIt>
+void parallelSort(_Manager &manager, _RandomIt first, _RandomIt last)
+{
+    using value_type = typename std::iterator_traits<_RandomIt>::value_type;
+    parallelSort(manager, first, last, std::less<value_type>());
+}
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file Executor.h
+ * @author Xu.Cao
+ * @details
+ *  本文件定义了共享同一组工作线程的多个逻辑执行器。
+ * 一个进程中往往同时存在多个线程池（计算、I/O 回调、后台任务等），
+ * 每个线程池各自创建线程会导致线程数量远超核心数。ExecutorGroup 只创建
+ * 与核心数相同的工作线程，并在其上创建多个 Executor：
+ * - 每个 Executor 拥有自己的任务队列、最小/最大份额和权重；
+ * - 工作线程优先满足未达到最小份额的执行器，其余空闲算力按权重分配给
+ *   有任务的执行器（按虚拟时间的步进调度），且不超过各自的最大份额；
+ * - 没有任何任务时，工作线程在 futex 上睡眠，不占用 CPU。
+ */
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "Task.h"
+#include "Future.h"
+#include "Lock.h"
+#include "Latch.h"
+#include "Queue.h"
+
+class ExecutorGroup;
+
+/**
+ * @class Executor
+ * @brief 逻辑执行器，由 ExecutorGroup 创建，生命周期与所属的 ExecutorGroup 一致
+ */
+class Executor final
+{
+    friend class ExecutorGroup;
+
+    static constexpr uint64_t VTIME_SCALE = 1 << 16; // 权重为 1 时每个任务推进的虚拟时间
+
+    LockFreeQueue<Task> _M_tasks;
+    const size_t _M_minShare; // 有任务时至少占用的工作线程数量
+    const size_t _M_maxShare; // 最多同时占用的工作线程数量
+    const uint64_t _M_stride; // 每执行一个任务推进的虚拟时间，与权重成反比
+    std::atomic<size_t> _M_running;
+    std::atomic<uint64_t> _M_vtime;
+    Latch _M_inFlight;
+    ExecutorGroup *_M_group;
+
+    Executor(ExecutorGroup *group, unsigned weight, size_t minShare,
+             size_t maxShare, size_t queueSize)
+        : _M_tasks(queueSize), _M_minShare(minShare),
+          _M_maxShare(maxShare ? maxShare : SIZE_MAX),
+          _M_stride(VTIME_SCALE / (weight ? weight : 1)),
+          _M_running(0), _M_vtime(0), _M_group(group) {}
+
+    // 在不超过 limit 的前提下占用一个工作线程
+    bool acquire(size_t limit)
+    {
+        size_t running = _M_running.load(std::memory_order_relaxed);
+        while (running < limit)
+        {
+            if (_M_running.compare_exchange_weak(running, running + 1,
+                                                 std::memory_order_acq_rel))
+                return true;
+        }
+        return false;
+    }
+
+public:
+    Executor(const Executor &other) = delete;
+    Executor &operator=(const Executor &other) = delete;
+
+    /**
+     * @brief 提交一个已经包装好的任务，不产生 future
+     * @return bool 执行器所属的组已经关闭时返回 false
+     */
+    bool post(Task &&task);
+
+    template <typename F, typename... ArgTp>
+    Future<typename std::result_of<F(ArgTp...)>::type> submit(F &&f, ArgTp &&...args)
+    {
+        using result_type = typename std::result_of<F(ArgTp...)>::type;
+
+        auto fn = std::bind(std::forward<F>(f), std::forward<ArgTp>(args)...);
+        PromiseTask<result_type, decltype(fn)> task_(std::move(fn));
+        Future<result_type> res = task_.getFuture();
+
+        post(Task(std::move(task_)));
+        return res;
+    }
+
+    // 阻塞等待本执行器中所有已提交的任务执行完成
+    void wait() { _M_inFlight.wait(); }
+
+    size_t running() const { return _M_running.load(std::memory_order_relaxed); }
+
+    size_t size() const { return _M_tasks.size(); }
+};
+
+/**
+ * @class ExecutorGroup
+ * @brief 一组共享的工作线程，以及在其上创建的多个逻辑执行器
+ */
+class ExecutorGroup final
+{
+    friend class Executor;
+
+    static constexpr size_t EXECUTOR_MAX = 64;
+
+    // 执行器只增不减，数组在构造时固定，工作线程无需加锁即可遍历
+    std::unique_ptr<Executor> _M_executors[EXECUTOR_MAX];
+    std::atomic<size_t> _M_executorNr;
+    std::atomic<uint64_t> _M_vclock; // 最近一次调度时的虚拟时间，新活跃的执行器从这里开始计时
+
+    std::vector<std::thread> _M_workers;
+    std::atomic<bool> _M_stop;
+    std::atomic<size_t> _M_idleNr;  // 正在睡眠或准备睡眠的工作线程数量
+    std::atomic<uint32_t> _M_signal; // 工作线程在这个字上睡眠，有新任务时递增并唤醒
+    spinLock _M_lock;                // 创建执行器时使用
+
+    void run(size_t index);
+
+    Executor *pick(size_t start);
+
+    bool hasWork() const;
+
+    void notify();
+
+public:
+    /**
+     * @param workerNr 工作线程数量，默认与 CPU 核心数相同
+     */
+    explicit ExecutorGroup(size_t workerNr = std::thread::hardware_concurrency());
+
+    ~ExecutorGroup();
+
+    ExecutorGroup(const ExecutorGroup &other) = delete;
+    ExecutorGroup &operator=(const ExecutorGroup &other) = delete;
+
+    /**
+     * @brief 创建一个逻辑执行器
+     *
+     * @param weight 权重，争抢工作线程时按权重分配执行机会
+     * @param minShare 有任务时至少占用的工作线程数量，所有执行器的最小份额之和不应超过工作线程数量
+     * @param maxShare 最多同时占用的工作线程数量，0 表示不限制
+     * @param queueSize 执行器自己的任务队列长度
+     * @return Executor* 创建失败（已经关闭或者数量达到上限）时返回 nullptr
+     */
+    Executor *create(unsigned weight = 1, size_t minShare = 0, size_t maxShare = 0,
+                     size_t queueSize = QUEUE_DEFAULT_SIZE);
+
+    // 等待所有执行器的任务完成，然后结束全部工作线程
+    void shutdown();
+
+    size_t workerNr() const { return _M_workers.size(); }
+};
+
+#endif
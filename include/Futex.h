@@ -0,0 +1,79 @@
+/**
+ * @file Futex.h
+ * @brief futex 系统调用的轻量封装
+ *
+ * 本文件封装了 Linux 的 futex 等待/唤醒操作，以及自旋等待时使用的 CPU 提示指令。
+ * futex 只在需要真正睡眠时才陷入内核，常规路径上只有一次原子操作，因此适合在
+ * 「先自旋、后睡眠」的同步原语中作为睡眠的后备手段。
+ *
+ * @author Xu.Cao
+ */
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex requires a plain 32-bit word");
+
+/**
+ * @brief 自旋等待中的 CPU 提示，降低自旋对同核超线程和总线的影响
+ */
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief 当 *word 仍然等于 expect 时睡眠，直到被唤醒
+ *
+ * 可能出现虚假唤醒，调用者需要在循环中重新检查条件。
+ * @param shared 是否跨进程共享，共享内存中的 futex 不能使用 PRIVATE 标志
+ */
+inline void futexWait(std::atomic<uint32_t> *word, uint32_t expect, bool shared = false)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word),
+            shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+            expect, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief 限时版本的 futexWait
+ */
+inline void futexWaitFor(std::atomic<uint32_t> *word, uint32_t expect,
+                         std::chrono::nanoseconds timeout, bool shared = false)
+{
+    if (timeout.count() <= 0)
+        return;
+
+    struct timespec ts;
+    ts.tv_sec = timeout.count() / 1000000000LL;
+    ts.tv_nsec = timeout.count() % 1000000000LL;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word),
+            shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+            expect, &ts, nullptr, 0);
+}
+
+/**
+ * @brief 唤醒至多 nr 个在 word 上睡眠的线程
+ */
+inline void futexWake(std::atomic<uint32_t> *word, int nr = INT32_MAX, bool shared = false)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word),
+            shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE,
+            nr, nullptr, nullptr, 0);
+}
+
+#endif
@@ -0,0 +1,666 @@
+/**
+ * @file Future.h
+ * @author Xu.Cao
+ * @details
+ *  本文件实现了线程池专用的 Promise/Future。
+ * 与 std::future 相比，这里的共享状态只有「一个原子状态字」和「一个结果槽」：
+ * - 状态字同时记录了是否就绪、是否异常、是否有等待者以及引用计数，
+ *   结果的发布、等待和释放都只需要一次原子操作；
+ * - get() 先短暂自旋，结果仍未就绪时才在状态字上通过 futex 睡眠；
+ * - 共享状态从每个线程（包括每个工作线程）私有的空闲链表中分配，
+ *   在分配线程中释放时不需要任何同步，在其他线程中释放时通过一次 CAS 归还给分配线程。
+ *
+ * PromiseTask 将一个可调用对象和 Promise 绑定在一起，作为 Task 的具体实现，
+ * 替代原来的 std::packaged_task。
+ */
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <new>
+#include <thread>
+#include <utility>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include "Futex.h"
+
+template <typename _Ty>
+class Future;
+
+template <typename _Ty>
+class Promise;
+
+/**
+ * @class StateCache
+ * @brief 当前线程中某个大小的 StatePool 缓存
+ *
+ * 每个线程第一次使用某个大小的 StatePool 时登记到线程局部的链表中，
+ * 工作线程空闲时通过 trimAll 一次归还全部大小的缓存，不需要知道共享状态的具体类型。
+ */
+class StateCache
+{
+    StateCache *_M_next;
+
+    static StateCache *&first()
+    {
+        static thread_local StateCache *head = nullptr;
+        return head;
+    }
+
+protected:
+    StateCache() : _M_next(first()) { first() = this; }
+    ~StateCache() = default;
+
+    // 从当前线程的链表中移除，只能在登记它的线程中调用
+    void unlink()
+    {
+        StateCache **link = &first();
+        while (*link && *link != this)
+            link = &(*link)->_M_next;
+        if (*link)
+            *link = _M_next;
+    }
+
+public:
+    // 归还缓存的全部内存块，包括其他线程已经归还的
+    virtual void trim() = 0;
+
+    // 缓存的内存块数量，包括其他线程已经归还的
+    virtual size_t cached() = 0;
+
+    static void trimAll()
+    {
+        for (StateCache *cache = first(); cache; cache = cache->_M_next)
+            cache->trim();
+    }
+
+    static size_t cachedAll()
+    {
+        size_t nr = 0;
+        for (StateCache *cache = first(); cache; cache = cache->_M_next)
+            nr += cache->cached();
+        return nr;
+    }
+};
+
+/**
+ * @template _Size 每个内存块的大小
+ * @class StatePool
+ * @brief 按线程划分的定长内存块空闲链表
+ *
+ * 每个内存块的头部记录分配它的线程（所有者）。在所有者线程中释放时直接放回它的本地链表，
+ * 不需要同步；在其他线程中释放时（例如任务执行完成时 Future 已经被丢弃），
+ * 内存块通过一次 CAS 放入所有者的归还链表，所有者在本地链表为空时一次性取回。
+ * 因此只提交不取结果的线程也会复用自己分配的内存块，稳定状态下不会调用 malloc。
+ * 本地链表最多缓存 FREE_LIST_MAX 个内存块，多余的直接归还给系统。
+ *
+ * 线程退出时，还没有归还的内存块由最后释放它们的线程直接归还给系统，
+ * 最后一个归还的线程负责销毁所有者。所有者登记为 StateCache，工作线程空闲时统一回收。
+ */
+template <size_t _Size>
+class StatePool
+{
+    struct Owner;
+
+    struct Block
+    {
+        union
+        {
+            Owner *owner; // 使用中：分配它的线程
+            Block *next;  // 空闲：链表中的下一个内存块
+        };
+    };
+
+    // 内存块头部的大小，保证返回给使用者的地址满足最大的基本对齐
+    static constexpr size_t HEADER = alignof(std::max_align_t);
+
+    struct Owner final : StateCache
+    {
+        Block *head; // 本地链表，只有所有者线程访问
+        size_t nr;
+        size_t live;                  // 由本线程分配、尚未归还给系统的内存块数量
+        std::atomic<Block *> remote;  // 其他线程归还的内存块，所有者退出后为 closed()
+        std::atomic<size_t> orphans; // 所有者退出时仍在使用中的内存块数量
+
+        Owner() : head(nullptr), nr(0), live(0), remote(nullptr), orphans(0) {}
+
+        void push(Block *block)
+        {
+            block->next = head;
+            head = block;
+            nr++;
+        }
+
+        void destroy(Block *block)
+        {
+            ::operator delete(block);
+            live--;
+        }
+
+        // 取回其他线程归还的内存块
+        bool reclaim()
+        {
+            Block *block = remote.exchange(nullptr, std::memory_order_acquire);
+            while (block)
+            {
+                Block *next = block->next;
+                push(block);
+                block = next;
+            }
+            return head;
+        }
+
+        void trim() override
+        {
+            reclaim();
+            while (head)
+            {
+                Block *next = head->next;
+                destroy(head);
+                head = next;
+            }
+            nr = 0;
+        }
+
+        size_t cached() override
+        {
+            reclaim();
+            return nr;
+        }
+
+        // 所有者线程退出：之后归还的内存块直接释放，最后一个负责销毁 Owner
+        void close()
+        {
+            unlink();
+            trim();
+            orphans.store(live, std::memory_order_relaxed);
+            Block *block = remote.exchange(closed(), std::memory_order_acq_rel);
+            size_t drained = 0;
+            while (block)
+            {
+                Block *next = block->next;
+                ::operator delete(block);
+                drained++;
+                block = next;
+            }
+            if (orphans.fetch_sub(drained, std::memory_order_acq_rel) == drained)
+                delete this;
+        }
+    };
+
+    struct Holder
+    {
+        Owner *owner;
+
+        Holder() : owner(new Owner()) {}
+        ~Holder() { owner->close(); }
+    };
+
+    static Block *closed()
+    {
+        static Block mark;
+        return &mark;
+    }
+
+    static Owner &local()
+    {
+        static thread_local Holder holder;
+        return *holder.owner;
+    }
+
+    // 在其他线程中释放：放入所有者的归还链表，所有者已经退出时直接释放
+    static void giveBack(Owner *owner, Block *block)
+    {
+        Block *head = owner->remote.load(std::memory_order_relaxed);
+        while (head != closed())
+        {
+            block->next = head;
+            if (owner->remote.compare_exchange_weak(head, block,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed))
+                return;
+        }
+
+        ::operator delete(block);
+        if (owner->orphans.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete owner;
+    }
+
+public:
+    static constexpr size_t FREE_LIST_MAX = 256;
+
+    static void *allocate()
+    {
+        Owner &owner = local();
+        Block *block;
+        if (owner.head || owner.reclaim())
+        {
+            block = owner.head;
+            owner.head = block->next;
+            owner.nr--;
+        }
+        else
+        {
+            block = static_cast<Block *>(::operator new(HEADER + _Size));
+            owner.live++;
+        }
+        block->owner = &owner;
+        return reinterpret_cast<char *>(block) + HEADER;
+    }
+
+    static void deallocate(void *ptr)
+    {
+        Block *block = reinterpret_cast<Block *>(static_cast<char *>(ptr) - HEADER);
+        Owner *owner = block->owner;
+        if (owner != &local())
+        {
+            giveBack(owner, block);
+            return;
+        }
+        if (owner->nr >= FREE_LIST_MAX)
+        {
+            owner->destroy(block);
+            return;
+        }
+        owner->push(block);
+    }
+
+    // 释放当前线程缓存的全部内存块，包括其他线程已经归还的
+    static void trim() { local().trim(); }
+};
+
+/* void 类型的结果使用一个空结构体占位，从而共用同一套共享状态实现 */
+struct VoidResult
+{
+};
+
+template <typename _Ty>
+struct FutureResult
+{
+    using type = _Ty;
+};
+
+template <>
+struct FutureResult<void>
+{
+    using type = VoidResult;
+};
+
+/* 引用类型的结果在结果槽中存放 reference_wrapper，get() 时转换回引用 */
+template <typename _Ty>
+struct FutureResult<_Ty &>
+{
+    using type = std::reference_wrapper<_Ty>;
+};
+
+/**
+ * @template _Ty 结果类型，void 使用 VoidResult 代替，引用使用 reference_wrapper 代替
+ * @class FutureState
+ * @brief Promise 和 Future 之间的共享状态
+ *
+ * 状态字的低 8 位是状态标志，高位是引用计数（Promise 和 Future 各持有一个）。
+ * 结果槽是一段未初始化的内存，就绪后其中存放结果或者 std::exception_ptr。
+ */
+template <typename _Ty>
+class FutureState final
+{
+    static constexpr uint32_t STATE_READY = 0x1;   // 结果已经写入
+    static constexpr uint32_t STATE_ERROR = 0x2;   // 结果槽中存放的是异常
+    static constexpr uint32_t STATE_WAITING = 0x4; // 有线程在 futex 上睡眠
+    static constexpr uint32_t STATE_FLAGS = 0xff;
+    static constexpr uint32_t STATE_REF = 0x100; // 一个引用计数单位
+
+    static constexpr int SPIN_NR = 128;
+    static constexpr int YIELD_NR = 16;
+
+    static constexpr size_t SLOT_SIZE = sizeof(_Ty) > sizeof(std::exception_ptr)
+                                            ? sizeof(_Ty)
+                                            : sizeof(std::exception_ptr);
+    static constexpr size_t SLOT_ALIGN = alignof(_Ty) > alignof(std::exception_ptr)
+                                             ? alignof(_Ty)
+                                             : alignof(std::exception_ptr);
+
+    std::atomic<uint32_t> _M_state;
+    typename std::aligned_storage<SLOT_SIZE, SLOT_ALIGN>::type _M_slot;
+
+    FutureState() : _M_state(2 * STATE_REF) {}
+    ~FutureState() = default;
+
+    _Ty *value() { return reinterpret_cast<_Ty *>(&_M_slot); }
+    std::exception_ptr *error() { return reinterpret_cast<std::exception_ptr *>(&_M_slot); }
+
+    void publish(uint32_t flags)
+    {
+        if (_M_state.fetch_or(flags, std::memory_order_acq_rel) & STATE_WAITING)
+        {
+            futexWake(&_M_state);
+        }
+    }
+
+    bool spin()
+    {
+        for (int i = 0; i < SPIN_NR; i++)
+        {
+            if (ready())
+                return true;
+            cpuRelax();
+        }
+        for (int i = 0; i < YIELD_NR; i++)
+        {
+            if (ready())
+                return true;
+            std::this_thread::yield();
+        }
+        return ready();
+    }
+
+    /**
+     * 标记存在等待者，返回标记后的状态字；结果已经就绪时返回 0
+     */
+    uint32_t markWaiting()
+    {
+        uint32_t state = _M_state.load(std::memory_order_acquire);
+        while (!(state & STATE_READY))
+        {
+            if (state & STATE_WAITING ||
+                _M_state.compare_exchange_weak(state, state | STATE_WAITING,
+                                               std::memory_order_acq_rel))
+            {
+                return state | STATE_WAITING;
+            }
+        }
+        return 0;
+    }
+
+public:
+    static_assert(SLOT_ALIGN <= alignof(std::max_align_t),
+                  "over-aligned results are not supported by the state pool");
+
+    static FutureState *create()
+    {
+        return new (StatePool<sizeof(FutureState)>::allocate()) FutureState();
+    }
+
+    // 释放一个引用，最后一个引用负责销毁结果并归还内存
+    void release()
+    {
+        uint32_t prev = _M_state.fetch_sub(STATE_REF, std::memory_order_acq_rel);
+        if ((prev & ~STATE_FLAGS) != STATE_REF)
+            return;
+
+        if (prev & STATE_ERROR)
+            error()->~exception_ptr();
+        else if (prev & STATE_READY)
+            value()->~_Ty();
+        this->~FutureState();
+        StatePool<sizeof(FutureState)>::deallocate(this);
+    }
+
+    template <typename... ArgTp>
+    void setValue(ArgTp &&...args)
+    {
+        new (&_M_slot) _Ty(std::forward<ArgTp>(args)...);
+        publish(STATE_READY);
+    }
+
+    void setException(std::exception_ptr e)
+    {
+        new (&_M_slot) std::exception_ptr(std::move(e));
+        publish(STATE_READY | STATE_ERROR);
+    }
+
+    bool ready() const { return _M_state.load(std::memory_order_acquire) & STATE_READY; }
+
+    void wait()
+    {
+        if (spin())
+            return;
+
+        uint32_t state;
+        while ((state = markWaiting()))
+        {
+            futexWait(&_M_state, state);
+        }
+    }
+
+    template <typename _Rep, typename _Period>
+    bool waitFor(const std::chrono::duration<_Rep, _Period> &timeout)
+    {
+        if (spin())
+            return true;
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        uint32_t state;
+        while ((state = markWaiting()))
+        {
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero())
+                return false;
+            futexWaitFor(&_M_state, state,
+                         std::chrono::duration_cast<std::chrono::nanoseconds>(left));
+        }
+        return true;
+    }
+
+    // 等待并取出结果，异常结果会被重新抛出
+    _Ty take()
+    {
+        wait();
+        if (_M_state.load(std::memory_order_acquire) & STATE_ERROR)
+            std::rethrow_exception(*error());
+        return std::move(*value());
+    }
+};
+
+/**
+ * @template _Ty 结果类型
+ * @class Future
+ * @brief 线程池任务的结果句柄，只能移动不能拷贝
+ *
+ * 接口与 std::future 保持一致：get() 只能调用一次，之后 valid() 返回 false。
+ */
+template <typename _Ty>
+class Future
+{
+protected:
+    using State = FutureState<typename FutureResult<_Ty>::type>;
+    State *_M_state;
+
+    friend class Promise<_Ty>;
+    explicit Future(State *state) : _M_state(state) {}
+
+    void reset()
+    {
+        if (_M_state)
+            _M_state->release();
+        _M_state = nullptr;
+    }
+
+public:
+    Future() : _M_state(nullptr) {}
+    ~Future() { reset(); }
+
+    Future(const Future &other) = delete;
+    Future &operator=(const Future &other) = delete;
+
+    Future(Future &&other) noexcept : _M_state(other._M_state) { other._M_state = nullptr; }
+    Future &operator=(Future &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            _M_state = other._M_state;
+            other._M_state = nullptr;
+        }
+        return *this;
+    }
+
+    bool valid() const { return _M_state; }
+
+    bool ready() const { return _M_state && _M_state->ready(); }
+
+    void wait() const
+    {
+        if (_M_state)
+            _M_state->wait();
+    }
+
+    template <typename _Rep, typename _Period>
+    bool waitFor(const std::chrono::duration<_Rep, _Period> &timeout) const
+    {
+        return !_M_state || _M_state->waitFor(timeout);
+    }
+
+    _Ty get()
+    {
+        if (!_M_state)
+            throw std::future_error(std::future_errc::no_state);
+        struct Guard
+        {
+            Future *future;
+            ~Guard() { future->reset(); }
+        } guard{this};
+        return _M_state->take();
+    }
+};
+
+template <>
+inline void Future<void>::get()
+{
+    if (!_M_state)
+        throw std::future_error(std::future_errc::no_state);
+    struct Guard
+    {
+        Future *future;
+        ~Guard() { future->reset(); }
+    } guard{this};
+    _M_state->take();
+}
+
+/**
+ * @template _Ty 结果类型
+ * @class Promise
+ * @brief 写入任务结果的一端，只能移动不能拷贝
+ *
+ * 如果 Promise 在写入结果之前被销毁，Future 会得到 broken_promise 异常。
+ */
+template <typename _Ty>
+class Promise
+{
+    using State = FutureState<typename FutureResult<_Ty>::type>;
+    State *_M_state;
+    bool _M_retrieved; // Future 是否已经被取走
+    bool _M_satisfied; // 结果是否已经写入
+
+    void check()
+    {
+        if (!_M_state)
+            throw std::future_error(std::future_errc::no_state);
+        if (_M_satisfied)
+            throw std::future_error(std::future_errc::promise_already_satisfied);
+        _M_satisfied = true;
+    }
+
+public:
+    Promise() : _M_state(State::create()), _M_retrieved(false), _M_satisfied(false) {}
+
+    ~Promise()
+    {
+        if (!_M_state)
+            return;
+        if (!_M_satisfied)
+        {
+            _M_state->setException(std::make_exception_ptr(
+                std::future_error(std::future_errc::broken_promise)));
+        }
+        // Future 没有被取走时，它持有的那份引用也在这里释放
+        if (!_M_retrieved)
+            _M_state->release();
+        _M_state->release();
+    }
+
+    Promise(const Promise &other) = delete;
+    Promise &operator=(const Promise &other) = delete;
+
+    Promise(Promise &&other) noexcept
+        : _M_state(other._M_state), _M_retrieved(other._M_retrieved),
+          _M_satisfied(other._M_satisfied)
+    {
+        other._M_state = nullptr;
+    }
+
+    bool valid() const { return _M_state; }
+
+    Future<_Ty> getFuture()
+    {
+        if (!_M_state)
+            throw std::future_error(std::future_errc::no_state);
+        if (_M_retrieved)
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        _M_retrieved = true;
+        return Future<_Ty>(_M_state);
+    }
+
+    template <typename... ArgTp>
+    void setValue(ArgTp &&...args)
+    {
+        check();
+        _M_state->setValue(std::forward<ArgTp>(args)...);
+    }
+
+    void setException(std::exception_ptr e)
+    {
+        check();
+        _M_state->setException(std::move(e));
+    }
+};
+
+/**
+ * @template _Ty 结果类型
+ * @template _Fn 无参的可调用对象类型
+ * @class PromiseTask
+ * @brief 执行可调用对象并将结果写入 Promise，作为 Task 的具体实现
+ */
+template <typename _Ty, typename _Fn>
+class PromiseTask
+{
+    Promise<_Ty> _M_promise;
+    _Fn _M_fn;
+
+    void invoke(std::false_type) { _M_promise.setValue(_M_fn()); }
+
+    void invoke(std::true_type)
+    {
+        _M_fn();
+        _M_promise.setValue();
+    }
+
+public:
+    explicit PromiseTask(_Fn &&fn) : _M_fn(std::move(fn)) {}
+
+    PromiseTask(PromiseTask &&other) = default;
+    PromiseTask(const PromiseTask &other) = delete;
+
+    Future<_Ty> getFuture() { return _M_promise.getFuture(); }
+
+    bool valid() const { return _M_promise.valid(); }
+
+    void operator()()
+    {
+        try
+        {
+            invoke(std::is_void<_Ty>());
+        }
+        catch (...)
+        {
+            _M_promise.setException(std::current_exception());
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file Gate.h
+ * @brief 线程池范围的暂停闸门
+ *
+ * 本文件定义了 PauseGate 类。闸门只有一个 32 位的纪元字，奇数表示关闭、偶数表示打开，
+ * 每次开关都使纪元加一；工作线程在两个任务之间读取纪元，关闭时在同一个字上通过 futex 睡眠。
+ * 因此暂停或恢复任意数量的线程都只需要一次原子操作，恢复时至多再加一次 futex 唤醒。
+ *
+ * @author Xu.Cao
+ */
+#ifndef GATE_H
+#define GATE_H
+
+#include <atomic>
+#include <cstdint>
+#include "Futex.h"
+
+/**
+ * @class PauseGate
+ * @brief 可以反复开关的闸门，关闭期间经过的线程都会睡眠
+ *
+ * 开关由调用者保证互斥（线程池在持有状态锁时操作），等待可以在任意线程中进行。
+ */
+class PauseGate
+{
+    std::atomic<uint32_t> _M_epoch;   // 奇数表示关闭，线程在这个字上睡眠
+    std::atomic<uint32_t> _M_waiters; // 正在睡眠或准备睡眠的线程数量
+
+public:
+    PauseGate() : _M_epoch(0), _M_waiters(0) {}
+
+    PauseGate(const PauseGate &other) = delete;
+    PauseGate &operator=(const PauseGate &other) = delete;
+
+    bool closed() const { return _M_epoch.load(std::memory_order_acquire) & 1; }
+
+    // 开关的次数
+    uint32_t epoch() const { return _M_epoch.load(std::memory_order_relaxed); }
+
+    // 关闭闸门，已经关闭时返回 false
+    bool close()
+    {
+        uint32_t epoch = _M_epoch.load(std::memory_order_relaxed);
+        while (!(epoch & 1))
+        {
+            if (_M_epoch.compare_exchange_weak(epoch, epoch + 1))
+                return true;
+        }
+        return false;
+    }
+
+    // 打开闸门并唤醒全部睡眠的线程，已经打开时返回 false
+    bool open()
+    {
+        uint32_t epoch = _M_epoch.load(std::memory_order_relaxed);
+        while (epoch & 1)
+        {
+            if (_M_epoch.compare_exchange_weak(epoch, epoch + 1))
+            {
+                // 与 wait 中先登记、再由内核比较纪元的顺序配对，不会丢失唤醒
+                if (_M_waiters.load())
+                    futexWake(&_M_epoch);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 闸门关闭时睡眠，直到闸门被打开
+     *
+     * 可能出现虚假唤醒，调用者需要在循环中重新检查自己的状态。
+     */
+    void wait()
+    {
+        uint32_t epoch = _M_epoch.load(std::memory_order_acquire);
+        if (!(epoch & 1))
+            return;
+
+        _M_waiters.fetch_add(1);
+        futexWait(&_M_epoch, epoch);
+        _M_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+#endif
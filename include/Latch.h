@@ -0,0 +1,102 @@
+/**
+ * @file Latch.h
+ * @brief 在途任务计数与完成闩锁
+ *
+ * 本文件定义了 Latch 类，用于统计「已提交但尚未执行完成」的任务数量。
+ * 计数的增减使用原子操作完成，只有使计数归零的那一次减少在互斥锁内进行并唤醒等待者，
+ * 因此等待方不会忙等，而任务执行方在常规路径上也不需要加锁。
+ *
+ * @author Xu.Cao
+ */
+#ifndef LATCH_H
+#define LATCH_H
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+/**
+ * @class Latch
+ * @brief 可重复使用的计数闩锁
+ *
+ * 与 C++20 的 std::latch 不同，这里的计数既可以增加也可以减少：
+ * - add() 在任务入队前调用，表示多了一个在途任务；
+ * - done() 在任务执行完成后调用，计数归零时唤醒全部等待者；
+ * - wait()/waitFor() 阻塞等待计数归零。
+ *
+ * @note 必须保证 add() 先于对应的 done() 发生，否则计数会下溢。
+ */
+class Latch
+{
+    std::atomic<size_t> _M_count;   // 在途任务数量
+    size_t _M_waiters;              // 正在等待计数归零的线程数量，受 _M_mutex 保护
+
+    std::mutex _M_mutex;
+    std::condition_variable _M_cond;
+
+public:
+    explicit Latch(size_t count = 0) : _M_count(count), _M_waiters(0) {}
+
+    Latch(const Latch &other) = delete;
+    Latch &operator=(const Latch &other) = delete;
+
+    void add(size_t nr = 1) { _M_count.fetch_add(nr); }
+
+    /**
+     * @brief 完成 nr 个任务
+     *
+     * 不会使计数归零的减少只是一次 CAS；使计数归零的那一次在互斥锁内减少并唤醒等待者。
+     * 等待者只有经过互斥锁才能返回，因此返回之后（例如随即销毁 Latch）
+     * done() 已经不再访问 Latch 的任何成员。
+     */
+    void done(size_t nr = 1)
+    {
+        size_t count = _M_count.load(std::memory_order_relaxed);
+        while (count != nr)
+        {
+            if (_M_count.compare_exchange_weak(count, count - nr))
+                return;
+        }
+
+        std::lock_guard<std::mutex> lock(_M_mutex);
+        // 加锁之后仍然可能有新的 add()，此时计数不会归零
+        if (_M_count.fetch_sub(nr) == nr && _M_waiters)
+            _M_cond.notify_all();
+    }
+
+    size_t count() const { return _M_count.load(std::memory_order_acquire); }
+
+    void wait()
+    {
+        // 即使计数已经归零也要经过互斥锁，等待使计数归零的 done() 离开临界区
+        std::unique_lock<std::mutex> lock(_M_mutex);
+        if (!_M_count.load())
+            return;
+
+        _M_waiters++;
+        _M_cond.wait(lock, [this]
+                     { return !_M_count.load(); });
+        _M_waiters--;
+    }
+
+    /**
+     * @brief 在限定时间内等待计数归零
+     * @return bool 计数是否已经归零
+     */
+    template <typename _Rep, typename _Period>
+    bool waitFor(const std::chrono::duration<_Rep, _Period> &timeout)
+    {
+        std::unique_lock<std::mutex> lock(_M_mutex);
+        if (!_M_count.load())
+            return true;
+
+        _M_waiters++;
+        bool zero = _M_cond.wait_for(lock, timeout, [this]
+                                     { return !_M_count.load(); });
+        _M_waiters--;
+        return zero;
+    }
+};
+
+#endif
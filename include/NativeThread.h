@@ -0,0 +1,73 @@
+/**
+ * @file NativeThread.h
+ * @brief 可以设置栈属性的原生线程
+ *
+ * std::thread 无法指定栈的大小，每个线程都会预留系统默认大小（通常为 8 MB）的栈。
+ * 本文件通过 pthread 属性创建线程，可以指定栈大小和保护页大小；
+ * 并提供 trimThreadStack，让空闲的线程归还栈中已经不再使用的物理内存。
+ *
+ * @author Xu.Cao
+ */
+#ifndef NATIVE_THREAD_H
+#define NATIVE_THREAD_H
+
+#include <pthread.h>
+#include <cstddef>
+#include <cstdint>
+
+constexpr size_t STACK_GUARD_DEFAULT = SIZE_MAX; // 使用系统默认的保护页大小
+
+/**
+ * 创建线程时使用的栈属性。
+ * - stackSize：栈的大小，0 表示使用系统默认值，不足 PTHREAD_STACK_MIN 时取该值；
+ * - guardSize：栈底保护页的大小，0 表示不设置保护页。
+ */
+struct ThreadAttr
+{
+    size_t stackSize;
+    size_t guardSize;
+
+    ThreadAttr(size_t _stackSize = 0, size_t _guardSize = STACK_GUARD_DEFAULT)
+        : stackSize(_stackSize), guardSize(_guardSize) {}
+};
+
+/**
+ * @class NativeThread
+ * @brief 对 pthread 的简单封装，只负责创建和回收
+ */
+class NativeThread final
+{
+    pthread_t _M_handle;
+    bool _M_joinable;
+
+public:
+    NativeThread() : _M_handle(), _M_joinable(false) {}
+
+    // 尚未回收的线程会被分离
+    ~NativeThread();
+
+    NativeThread(const NativeThread &other) = delete;
+    NativeThread &operator=(const NativeThread &other) = delete;
+
+    /**
+     * @brief 在新线程中执行 func(arg)
+     *
+     * 按 attr 创建失败（例如栈大小不合法）时，退回到系统默认属性重试。
+     * @return bool 线程已经启动过或者创建失败时返回 false
+     */
+    bool start(void (*func)(void *), void *arg, const ThreadAttr &attr = ThreadAttr());
+
+    bool joinable() const { return _M_joinable; }
+
+    void join();
+};
+
+/**
+ * @brief 释放当前线程栈中低于当前栈顶的物理内存
+ *
+ * 只能在线程空闲、调用栈较浅时调用；释放的页面在下次使用时由内核重新分配。
+ * @return size_t 释放的字节数，无法取得栈的范围时返回 0
+ */
+size_t trimThreadStack();
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * @file Phases.h
+ * @author Xu.Cao
+ * @details
+ *  本文件提供分阶段（BSP）并行执行：每个阶段有相同数量的任务，
+ * 一个阶段的全部任务完成之后，下一个阶段才开始。
+ *
+ *  参与者（调用线程和若干帮助任务）从同一个递增的票号中领取任务，票号 t 对应第 t / n 个阶段
+ * 的第 t % n 个任务。领到尚未开放阶段的票号时，参与者在阶段屏障上等待，阶段开放后直接执行，
+ * 不再经过任务队列；完成某个阶段最后一个任务的参与者负责开放下一个阶段。
+ * 屏障不要求固定的参与者数量，晚到的帮助任务直接加入，没有帮助任务时调用者独自完成全部阶段，
+ * 因此可以在线程池的工作线程中调用。线程池需要提供 bool post(Task &&) 和 size_t workerNr()。
+ */
+#ifndef PHASES_H
+#define PHASES_H
+
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+#include "Task.h"
+#include "Futex.h"
+#include "Queue.h"
+
+constexpr unsigned PHASE_SPIN_ROUND = 1024; // 等待阶段开放时先自旋的次数
+constexpr unsigned PHASE_YIELD_ROUND = 64;  // 自旋之后让出 CPU 的次数，之后在 futex 上睡眠
+
+/**
+ * @class PhaseRun
+ * @brief 一次分阶段执行的共享状态，使用引用计数，最后一个离开的参与者负责释放
+ */
+template <typename _Fn, typename _Between>
+class PhaseRun final
+{
+    _Fn _M_body;
+    _Between _M_between;
+    const size_t _M_taskNr;
+    const size_t _M_phaseNr;
+
+    std::atomic<size_t> _M_next; // 下一个票号
+    char _M_pad0[CACHE_LINE_SIZE - sizeof(size_t)];
+    std::atomic<size_t> _M_done; // 已经完成的任务数量，按阶段依次累加
+    char _M_pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+    std::atomic<uint32_t> _M_phase;    // 已经开放的阶段，全部结束后等于阶段数
+    std::atomic<uint32_t> _M_sleepers; // 在 futex 上睡眠或准备睡眠的参与者数量
+
+    std::atomic<size_t> _M_refs;
+    std::atomic<bool> _M_failed;
+    std::exception_ptr _M_error;
+
+    PhaseRun(const _Fn &body, const _Between &between, size_t taskNr, size_t phaseNr, size_t refs)
+        : _M_body(body), _M_between(between), _M_taskNr(taskNr), _M_phaseNr(phaseNr),
+          _M_next(0), _M_done(0), _M_phase(0), _M_sleepers(0), _M_refs(refs), _M_failed(false) {}
+
+    void fail()
+    {
+        if (!_M_failed.exchange(true))
+            _M_error = std::current_exception();
+    }
+
+    // 等待第 phase 个阶段开放
+    void waitPhase(uint32_t phase)
+    {
+        unsigned round = 0;
+        uint32_t now;
+        while ((now = _M_phase.load(std::memory_order_acquire)) < phase)
+        {
+            if (round < PHASE_SPIN_ROUND)
+            {
+                cpuRelax();
+            }
+            else if (round < PHASE_SPIN_ROUND + PHASE_YIELD_ROUND)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                // 先登记再由内核比较阶段，与 open 中先开放再检查登记相对应
+                _M_sleepers.fetch_add(1);
+                futexWait(&_M_phase, now);
+                _M_sleepers.fetch_sub(1, std::memory_order_relaxed);
+            }
+            round++;
+        }
+    }
+
+    void open(uint32_t phase)
+    {
+        _M_phase.store(phase);
+        if (_M_sleepers.load())
+            futexWake(&_M_phase);
+    }
+
+    void work()
+    {
+        const size_t total = _M_taskNr * _M_phaseNr;
+        size_t ticket;
+        while ((ticket = _M_next.fetch_add(1, std::memory_order_relaxed)) < total)
+        {
+            size_t phase = ticket / _M_taskNr;
+            waitPhase(phase);
+
+            // 出现异常后剩余的任务不再执行，但仍然需要计数，保证阶段可以推进
+            if (!_M_failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    _M_body(phase, ticket - phase * _M_taskNr);
+                }
+                catch (...)
+                {
+                    fail();
+                }
+            }
+
+            if (_M_done.fetch_add(1, std::memory_order_acq_rel) + 1 == (phase + 1) * _M_taskNr)
+            {
+                // 本阶段的最后一个任务：执行阶段完成的回调，然后开放下一个阶段
+                if (!_M_failed.load(std::memory_order_relaxed))
+                {
+                    try
+                    {
+                        _M_between(phase);
+                    }
+                    catch (...)
+                    {
+                        fail();
+                    }
+                }
+                open(phase + 1);
+            }
+        }
+    }
+
+    void release()
+    {
+        if (_M_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    static void help(void *arg)
+    {
+        PhaseRun *run = static_cast<PhaseRun *>(arg);
+        run->work();
+        run->release();
+    }
+
+public:
+    /**
+     * @brief 依次执行 phaseNr 个阶段，阻塞直到全部完成
+     *
+     * 第 p 个阶段执行 body(p, 0) ... body(p, taskNr - 1)，全部完成后由最后一个完成的
+     * 参与者调用 between(p)，之后第 p + 1 个阶段才开始；最后一个阶段之后同样调用一次，
+     * 共调用 phaseNr 次，全部返回后 run 才返回。
+     * 出现异常时剩余的任务和回调被跳过，之后在调用线程中重新抛出第一个异常。
+     * @note 阶段数需要小于 2^32
+     */
+    template <typename _Manager>
+    static void run(_Manager &manager, size_t taskNr, size_t phaseNr,
+                    const _Fn &body, const _Between &between)
+    {
+        if (!taskNr || !phaseNr)
+            return;
+
+        size_t helperNr = std::min(taskNr - 1, manager.workerNr());
+        PhaseRun *job = new PhaseRun(body, between, taskNr, phaseNr, helperNr + 1);
+        for (size_t i = 0; i < helperNr; i++)
+        {
+            // 线程池不在运行状态时，由调用者自己完成
+            if (!manager.post(Task(&PhaseRun::help, job)))
+                job->release();
+        }
+
+        job->work();
+        // 其他参与者可能还在执行最后一个阶段
+        job->waitPhase(phaseNr);
+
+        std::exception_ptr error = job->_M_error;
+        job->release();
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+/**
+ * @brief 在线程池上分阶段执行 body(phase, index)，每个阶段 taskNr 个任务
+ *
+ * between(phase) 在第 phase 个阶段全部完成之后、下一个阶段开始之前执行一次，
+ * 最后一个阶段之后也会执行，可以用于交换缓冲区、汇总结果等只需要一个线程完成的工作。
+ */
+template <typename _Manager, typename _Fn, typename _Between>
+void runPhases(_Manager &manager, size_t taskNr, size_t phaseNr, const _Fn &body, const _Between &between)
+{
+    PhaseRun<_Fn, _Between>::run(manager, taskNr, phaseNr, body, between);
+}
+
+template <typename _Manager, typename _Fn>
+void runPhases(_Manager &manager, size_t taskNr, size_t phaseNr, const _Fn &body)
+{
+    runPhases(manager, taskNr, phaseNr, body, [](size_t) {});
+}
+
+#endif
@@ -0,0 +1,407 @@
+/**
+ * @file Pipeline.h
+ * @author Xu.Cao
+ * @details
+ *  本文件定义了运行在线程池上的线性流水线。
+ * 数据源依次产生数据项，每个数据项按顺序经过各个阶段，阶段分为三种：
+ * - STAGE_PARALLEL：可以同时处理多个数据项，由携带数据项的工作线程直接执行，没有交接；
+ * - STAGE_SERIAL_OUT_OF_ORDER：同一时刻只处理一个数据项，先到先处理。数据项放入阶段的
+ *   多生产者单消费者环形队列，第一个到达的线程成为处理者，依次处理队列中的数据项；
+ * - STAGE_SERIAL_IN_ORDER：同一时刻只处理一个数据项，并且按照数据源产生的顺序处理。
+ *   数据项按序号放入重排槽位，处理者按序号依次处理。
+ * 处理者接着携带自己的数据项前进，其余数据项作为新的任务提交到线程池。
+ *
+ *  令牌数量限制了同时在流水线中的数据项数量，数据项的存储在执行前一次性分配：
+ * 序号为 s 的数据项只有在序号为 s - tokens 的数据项离开流水线后才会产生，
+ * 因此内存占用固定，吞吐量由最慢的阶段决定。
+ */
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <exception>
+#include "Task.h"
+#include "Latch.h"
+#include "Queue.h"
+#include "Futex.h"
+
+enum StageMode
+{
+    STAGE_PARALLEL,
+    STAGE_SERIAL_IN_ORDER,
+    STAGE_SERIAL_OUT_OF_ORDER,
+};
+
+constexpr size_t PIPELINE_TOKENS_DEFAULT = 64;
+
+/**
+ * @template _Ty 数据项的类型，需要可默认构造，数据源和各个阶段在同一个对象上原地修改
+ * @class Pipeline
+ * @brief 线性流水线，构建一次后可以反复执行
+ */
+template <typename _Ty>
+class Pipeline final
+{
+    struct Item
+    {
+        _Ty value;
+        size_t seq;
+        size_t stage;             // 下一个要进入的阶段
+        std::atomic<bool> free;   // 是否已经离开流水线，可以复用
+        Pipeline *pipeline;
+    };
+
+    struct Stage
+    {
+        StageMode mode;
+        std::function<void(_Ty &)> func;
+
+        // 乱序串行阶段：到达的数据项和尚未处理的数量，数量从 0 变为 1 的线程成为处理者
+        std::unique_ptr<MpscQueue<Item *>> ring;
+        std::atomic<size_t> pending;
+
+        // 有序串行阶段：按序号放置的数据项、正在处理的标记和下一个要处理的序号
+        std::unique_ptr<std::atomic<Item *>[]> slots;
+        std::atomic<bool> busy;
+        size_t next;
+
+        size_t tokens; // ring 或 slots 按多少个令牌分配，为 0 时尚未分配
+
+        Stage(StageMode _mode, std::function<void(_Ty &)> &&_func)
+            : mode(_mode), func(std::move(_func)), pending(0), busy(false), next(0), tokens(0) {}
+    };
+
+    std::vector<std::unique_ptr<Stage>> _M_stages;
+    std::unique_ptr<Item[]> _M_items;
+    size_t _M_tokens;
+
+    // 数据源只由持有 _M_sourceBusy 的线程调用
+    std::function<bool(_Ty &)> _M_source;
+    std::atomic<bool> _M_sourceBusy;
+    bool _M_exhausted;
+    size_t _M_seq; // 下一个数据项的序号
+
+    // 当前执行所使用的线程池，以及向它提交任务的函数；线程池暂停时推迟，只有终止时失败
+    void *_M_manager;
+    bool (*_M_post)(void *manager, Task &&task);
+    Latch _M_tasks; // 正在执行或等待执行的任务数量，归零时本次执行结束
+    std::atomic<bool> _M_failed;
+    std::exception_ptr _M_error;
+
+    template <typename _Manager>
+    static bool postTo(void *manager, Task &&task)
+    {
+        return static_cast<_Manager *>(manager)->postOrDefer(std::move(task));
+    }
+
+    void reset(size_t tokens);
+
+    void apply(Stage &stage, Item *item);
+
+    // 将数据项交给线程池，从 item->stage 阶段继续执行
+    void launch(Item *item);
+
+    static void carry(void *arg);
+
+    void advance(Item *item);
+
+    bool enterOutOfOrder(Stage &stage, Item *item, size_t index);
+
+    bool enterInOrder(Stage &stage, Item *item, size_t index);
+
+    void pump();
+
+    size_t execute(void *manager, bool (*post)(void *, Task &&),
+                   std::function<bool(_Ty &)> &&source, size_t tokens);
+
+public:
+    Pipeline() : _M_tokens(0), _M_sourceBusy(false), _M_exhausted(true), _M_seq(0),
+                 _M_manager(nullptr), _M_post(nullptr), _M_failed(false) {}
+
+    Pipeline(const Pipeline &other) = delete;
+    Pipeline &operator=(const Pipeline &other) = delete;
+
+    /**
+     * @brief 在末尾添加一个阶段
+     * @return Pipeline& 便于链式构建
+     */
+    Pipeline &addStage(StageMode mode, std::function<void(_Ty &)> func)
+    {
+        _M_stages.emplace_back(new Stage(mode, std::move(func)));
+        return *this;
+    }
+
+    /**
+     * @brief 在线程池上执行流水线，阻塞直到数据源耗尽并且所有数据项离开流水线
+     *
+     * 同一条流水线同一时刻只能有一次执行。如果数据源或者某个阶段抛出异常，
+     * 数据源停止产生新的数据项，已经产生的数据项跳过剩余的阶段，之后重新抛出第一个异常。
+     *
+     * 线程池暂停或尚未启动时，数据项等到线程池运行后才继续前进；
+     * 只有线程池已经终止时，数据项才在提交它的线程中直接执行。
+     *
+     * @template _Manager 提供 bool postOrDefer(Task &&) 的线程池，例如 ThreadManager
+     * @param source 向参数中写入下一个数据项并返回 true，耗尽时返回 false
+     * @param tokens 同时在流水线中的数据项数量上限
+     * @return size_t 数据源产生的数据项数量
+     */
+    template <typename _Manager>
+    size_t run(_Manager &manager, std::function<bool(_Ty &)> source,
+               size_t tokens = PIPELINE_TOKENS_DEFAULT)
+    {
+        return execute(&manager, &Pipeline::postTo<_Manager>, std::move(source), tokens);
+    }
+
+    size_t size() const { return _M_stages.size(); }
+};
+
+template <typename _Ty>
+void Pipeline<_Ty>::reset(size_t tokens)
+{
+    if (tokens != _M_tokens)
+    {
+        _M_tokens = tokens;
+        _M_items.reset(new Item[tokens]);
+    }
+    for (size_t i = 0; i < tokens; i++)
+    {
+        _M_items[i].free.store(true, std::memory_order_relaxed);
+        _M_items[i].pipeline = this;
+    }
+
+    // 只在令牌数量变化或者阶段是新添加的时候分配，之后的执行只重置下标。
+    // 上一次执行结束时所有数据项都已经离开流水线：环形队列为空，读写位置继续递增即可；
+    // 槽位也都已经取走，这里仍然清空，不依赖上一次执行的结束状态
+    for (auto &stage : _M_stages)
+    {
+        stage->pending.store(0, std::memory_order_relaxed);
+        stage->busy.store(false, std::memory_order_relaxed);
+        stage->next = 0;
+        if (stage->mode == STAGE_SERIAL_OUT_OF_ORDER)
+        {
+            // 同时在流水线中的数据项不超过令牌数量，环形队列不会满
+            if (stage->tokens != tokens)
+                stage->ring.reset(new MpscQueue<Item *>(tokens));
+        }
+        else if (stage->mode == STAGE_SERIAL_IN_ORDER)
+        {
+            if (stage->tokens != tokens)
+                stage->slots.reset(new std::atomic<Item *>[tokens]);
+            for (size_t i = 0; i < tokens; i++)
+                stage->slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+        stage->tokens = tokens;
+    }
+}
+
+template <typename _Ty>
+void Pipeline<_Ty>::apply(Stage &stage, Item *item)
+{
+    // 出现异常后，数据项仍然需要经过各个阶段以维持顺序，但不再处理
+    if (_M_failed.load(std::memory_order_relaxed))
+        return;
+    try
+    {
+        stage.func(item->value);
+    }
+    catch (...)
+    {
+        if (!_M_failed.exchange(true))
+            _M_error = std::current_exception();
+    }
+}
+
+template <typename _Ty>
+void Pipeline<_Ty>::launch(Item *item)
+{
+    _M_tasks.add();
+    // 线程池暂停时数据项被推迟到恢复运行；只有线程池已经终止时，
+    // 才直接在当前线程中执行，保证本次执行能够结束
+    if (!_M_post(_M_manager, Task(&Pipeline::carry, item)))
+        carry(item);
+}
+
+template <typename _Ty>
+void Pipeline<_Ty>::carry(void *arg)
+{
+    Item *item = static_cast<Item *>(arg);
+    Pipeline *pipeline = item->pipeline;
+    pipeline->advance(item);
+    // 这是任务对流水线的最后一次访问，计数归零后流水线可能已经被销毁
+    pipeline->_M_tasks.done();
+}
+
+template <typename _Ty>
+void Pipeline<_Ty>::advance(Item *item)
+{
+    for (size_t s = item->stage; s < _M_stages.size(); s++)
+    {
+        Stage &stage = *_M_stages[s];
+        switch (stage.mode)
+        {
+        case STAGE_PARALLEL:
+            apply(stage, item);
+            break;
+        case STAGE_SERIAL_OUT_OF_ORDER:
+            if (!enterOutOfOrder(stage, item, s))
+                return;
+            break;
+        case STAGE_SERIAL_IN_ORDER:
+            if (!enterInOrder(stage, item, s))
+                return;
+            break;
+        }
+    }
+
+    // 离开流水线，归还令牌后尝试让数据源产生新的数据项
+    item->free.store(true, std::memory_order_seq_cst);
+    pump();
+}
+
+/**
+ * 返回 true 表示数据项已经在本阶段处理完成，由当前线程继续携带；
+ * 返回 false 表示数据项交给了其他处理者，当前线程不再负责它。
+ */
+template <typename _Ty>
+bool Pipeline<_Ty>::enterOutOfOrder(Stage &stage, Item *item, size_t index)
+{
+    stage.ring->push(&item, 1);
+    if (stage.pending.fetch_add(1, std::memory_order_acq_rel) != 0)
+        return false;
+
+    // 成为处理者，直到队列中没有数据项；入队先于计数，因此计数为正时队列中一定有数据项。
+    // 先入队的数据项可能还没有计数，因此自己的数据项不一定由自己处理
+    bool processed = false;
+    do
+    {
+        Item *other;
+        while (!stage.ring->pop(&other, 1))
+        {
+            cpuRelax();
+        }
+        apply(stage, other);
+        if (other == item)
+        {
+            processed = true;
+        }
+        else
+        {
+            other->stage = index + 1;
+            launch(other);
+        }
+    } while (stage.pending.fetch_sub(1, std::memory_order_acq_rel) != 1);
+
+    return processed;
+}
+
+template <typename _Ty>
+bool Pipeline<_Ty>::enterInOrder(Stage &stage, Item *item, size_t index)
+{
+    // 同时在流水线中的数据项序号相差小于令牌数量，按序号取模不会冲突
+    stage.slots[item->seq % _M_tokens].store(item, std::memory_order_seq_cst);
+
+    bool processed = false;
+    while (!stage.busy.exchange(true, std::memory_order_seq_cst))
+    {
+        Item *other;
+        while ((other = stage.slots[stage.next % _M_tokens].load(std::memory_order_acquire)))
+        {
+            stage.slots[stage.next % _M_tokens].store(nullptr, std::memory_order_relaxed);
+            stage.next++;
+            apply(stage, other);
+            if (other == item)
+            {
+                processed = true;
+            }
+            else
+            {
+                other->stage = index + 1;
+                launch(other);
+            }
+        }
+
+        // 释放后再检查一次：下一个数据项可能恰好在释放前到达，
+        // 而它的携带者看到本阶段正忙就已经离开了
+        size_t next = stage.next;
+        stage.busy.store(false, std::memory_order_seq_cst);
+        if (!stage.slots[next % _M_tokens].load(std::memory_order_seq_cst))
+            break;
+    }
+    return processed;
+}
+
+template <typename _Ty>
+void Pipeline<_Ty>::pump()
+{
+    // 与有序串行阶段相同，数据源同一时刻只由一个线程调用
+    while (!_M_sourceBusy.exchange(true, std::memory_order_seq_cst))
+    {
+        Item *item;
+        while (!_M_exhausted &&
+               (item = &_M_items[_M_seq % _M_tokens])->free.load(std::memory_order_seq_cst))
+        {
+            bool produced = false;
+            if (!_M_failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    produced = _M_source(item->value);
+                }
+                catch (...)
+                {
+                    if (!_M_failed.exchange(true))
+                        _M_error = std::current_exception();
+                }
+            }
+            if (!produced)
+            {
+                _M_exhausted = true;
+                break;
+            }
+
+            item->free.store(false, std::memory_order_relaxed);
+            item->seq = _M_seq++;
+            item->stage = 0;
+            launch(item);
+        }
+
+        bool more = !_M_exhausted;
+        size_t seq = _M_seq;
+        _M_sourceBusy.store(false, std::memory_order_seq_cst);
+        if (!more || !_M_items[seq % _M_tokens].free.load(std::memory_order_seq_cst))
+            break;
+    }
+}
+
+template <typename _Ty>
+size_t Pipeline<_Ty>::execute(void *manager, bool (*post)(void *, Task &&),
+                              std::function<bool(_Ty &)> &&source, size_t tokens)
+{
+    reset(tokens ? tokens : 1);
+    _M_manager = manager;
+    _M_post = post;
+    _M_source = std::move(source);
+    _M_exhausted = false;
+    _M_seq = 0;
+    _M_failed.store(false, std::memory_order_relaxed);
+    _M_error = nullptr;
+
+    // 调用者自己也算作一个任务，避免在填充流水线的过程中计数提前归零
+    _M_tasks.add();
+    pump();
+    _M_tasks.done();
+    _M_tasks.wait();
+
+    _M_source = nullptr;
+    _M_manager = nullptr;
+    _M_post = nullptr;
+    if (_M_error)
+        std::rethrow_exception(_M_error);
+    return _M_seq;
+}
+
+#endif
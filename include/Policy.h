@@ -0,0 +1,211 @@
+/**
+ * @file Policy.h
+ * @author Xu.Cao
+ * @details
+ *  本文件定义了 BasicThreadManager 可以在编译期选择的策略。
+ * 策略都是普通的类，通过模板参数传入，调用全部在编译期确定并可以被内联；
+ * 不需要的功能（例如统计）选择空实现后不会产生任何开销。
+ * - 等待策略（WaitPolicy）：工作线程取不到任务时如何等待，以及提交任务后如何唤醒；
+ *   接受直接交付的工作线程使用带邮箱的 wait，需要睡眠时在自己的邮箱上睡眠；
+ * - 统计策略（StatsPolicy）：记录提交、执行和空转次数；
+ * - 锁策略（LockPolicy）：提交任务和改变线程池状态时使用的锁，需要提供 lock()/unlock()，
+ *   可以使用 spinLock、std::mutex 或者 NullLock。
+ * 队列策略（QueuePolicy）直接使用具体的队列类型，例如 LockFreeQueue<Task>。
+ */
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include "Futex.h"
+
+/* 工作线程单任务邮箱的状态，参见 BasicThread::offer */
+constexpr uint32_t HANDOFF_BUSY = 0;    // 线程忙碌，或者没有开启直接交付
+constexpr uint32_t HANDOFF_IDLE = 1;    // 线程空闲，正在自旋或者让出 CPU
+constexpr uint32_t HANDOFF_PARKED = 2;  // 线程空闲，在邮箱上睡眠，交付后需要 futexWake
+constexpr uint32_t HANDOFF_CLAIMED = 3; // 提交者已经占用邮箱，正在写入任务
+constexpr uint32_t HANDOFF_READY = 4;   // 任务已经写入，等待线程取走
+
+/**
+ * @class YieldWait
+ * @brief 取不到任务时让出 CPU，这是线程池一直以来的行为
+ *
+ * 提交任务后不需要唤醒，但空闲的工作线程会持续占用 CPU 时间片。
+ */
+struct YieldWait
+{
+    template <typename _Pred>
+    void wait(unsigned, _Pred &&) { std::this_thread::yield(); }
+
+    // 不会睡眠，邮箱由工作线程在下一轮直接检查
+    template <typename _Pred>
+    void wait(unsigned round, _Pred &&hasWork, std::atomic<uint32_t> &) { wait(round, hasWork); }
+
+    void notify() {}
+
+    void notifyAll() {}
+
+    // 管理线程每轮检查之间的间隔
+    void pace() { std::this_thread::yield(); }
+};
+
+/**
+ * @class SpinWait
+ * @brief 取不到任务时忙等，延迟最低，但空闲时每个工作线程都会占满一个核心
+ */
+struct SpinWait
+{
+    template <typename _Pred>
+    void wait(unsigned, _Pred &&) { cpuRelax(); }
+
+    template <typename _Pred>
+    void wait(unsigned round, _Pred &&hasWork, std::atomic<uint32_t> &) { wait(round, hasWork); }
+
+    void notify() {}
+
+    void notifyAll() {}
+
+    void pace() { std::this_thread::yield(); }
+};
+
+/**
+ * @class ParkWait
+ * @brief 先自旋，再让出 CPU，最后在 futex 上睡眠，直到有新任务提交
+ *
+ * 睡眠前工作线程先登记自己，再检查一次是否有任务；提交者先写入任务，
+ * 再检查是否有睡眠的线程，两者之间的全序保证不会丢失唤醒。
+ */
+class ParkWait
+{
+    static constexpr unsigned SPIN_ROUND = 64;
+    static constexpr unsigned YIELD_ROUND = 128;
+
+    std::atomic<uint32_t> _M_seq;      // 工作线程在这个字上睡眠，唤醒时递增
+    std::atomic<uint32_t> _M_sleepers; // 正在睡眠或准备睡眠的工作线程数量
+
+public:
+    ParkWait() : _M_seq(0), _M_sleepers(0) {}
+
+    /**
+     * @param round 连续取不到任务的次数
+     * @param hasWork 登记为睡眠状态后再次检查是否有任务（或者状态是否改变）
+     */
+    template <typename _Pred>
+    void wait(unsigned round, _Pred &&hasWork)
+    {
+        if (round < SPIN_ROUND)
+        {
+            cpuRelax();
+            return;
+        }
+        if (round < YIELD_ROUND)
+        {
+            std::this_thread::yield();
+            return;
+        }
+
+        uint32_t seq = _M_seq.load(std::memory_order_acquire);
+        _M_sleepers.fetch_add(1);
+        if (!hasWork())
+        {
+            futexWait(&_M_seq, seq);
+        }
+        _M_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 接受直接交付的工作线程使用的等待，睡眠在线程自己的邮箱上
+     *
+     * 邮箱从 IDLE 改为 PARKED 之后再检查一次是否有任务；交付任务或者唤醒的一方
+     * 先写入任务，再把邮箱从 PARKED 改走并调用 futexWake，因此只唤醒这一个线程。
+     * @param mailbox 线程的邮箱状态，调用前为 HANDOFF_IDLE
+     */
+    template <typename _Pred>
+    void wait(unsigned round, _Pred &&hasWork, std::atomic<uint32_t> &mailbox)
+    {
+        if (round < YIELD_ROUND)
+        {
+            wait(round, hasWork);
+            return;
+        }
+
+        uint32_t state = HANDOFF_IDLE;
+        if (!mailbox.compare_exchange_strong(state, HANDOFF_PARKED))
+            return;
+        if (!hasWork())
+        {
+            futexWait(&mailbox, HANDOFF_PARKED);
+        }
+        // 虚假唤醒时邮箱仍是 PARKED，恢复为 IDLE，交付的一方不必再唤醒
+        state = HANDOFF_PARKED;
+        mailbox.compare_exchange_strong(state, HANDOFF_IDLE);
+    }
+
+    // 任务入队后调用，只唤醒一个睡眠的线程
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_M_sleepers.load(std::memory_order_relaxed))
+        {
+            _M_seq.fetch_add(1, std::memory_order_release);
+            futexWake(&_M_seq, 1);
+        }
+    }
+
+    // 状态改变（暂停、关闭等）或者任务只能由特定线程执行时，唤醒全部线程
+    void notifyAll()
+    {
+        _M_seq.fetch_add(1);
+        futexWake(&_M_seq);
+    }
+
+    void pace() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+};
+
+/**
+ * @class NoStats
+ * @brief 不做任何统计，所有调用都会被编译器消除
+ */
+struct NoStats
+{
+    void onSubmit() {}
+    void onExecute() {}
+    void onIdle() {}
+};
+
+/**
+ * @class CountingStats
+ * @brief 使用原子计数器统计提交、执行和空转的次数
+ */
+class CountingStats
+{
+    std::atomic<size_t> _M_submitted, _M_executed, _M_idle;
+
+public:
+    CountingStats() : _M_submitted(0), _M_executed(0), _M_idle(0) {}
+
+    void onSubmit() { _M_submitted.fetch_add(1, std::memory_order_relaxed); }
+    void onExecute() { _M_executed.fetch_add(1, std::memory_order_relaxed); }
+    void onIdle() { _M_idle.fetch_add(1, std::memory_order_relaxed); }
+
+    size_t submitted() const { return _M_submitted.load(std::memory_order_relaxed); }
+    size_t executed() const { return _M_executed.load(std::memory_order_relaxed); }
+    size_t idle() const { return _M_idle.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @class NullLock
+ * @brief 空锁，只适用于只有一个线程提交任务并改变线程池状态的场景
+ *
+ * 管理线程和提交线程之间没有互斥，因此管理线程不能修改提交线程正在写入的数据：
+ * 使用 NullLock 的线程池忽略 PoolOptions::idleTrim，trim() 也只能在提交线程中调用。
+ */
+struct NullLock
+{
+    void lock() {}
+    void unlock() {}
+};
+
+#endif
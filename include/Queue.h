@@ -6,8 +6,27 @@
 #include <thread>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 constexpr size_t QUEUE_DEFAULT_SIZE = 1000;
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// 归还 [begin, begin + bytes) 内部完整的页面，返回归还的字节数，调用者保证其中没有存活的元素
+inline size_t releasePages(const void *begin, size_t bytes)
+{
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t first = reinterpret_cast<uintptr_t>(begin);
+    uintptr_t low = (first + page - 1) & ~(page - 1);
+    uintptr_t high = (first + bytes) & ~(page - 1);
+    if (high <= low || madvise(reinterpret_cast<void *>(low), high - low, MADV_DONTNEED) != 0)
+        return 0;
+    return high - low;
+}
 
 /**
  * @template _TyData
@@ -17,6 +36,9 @@ constexpr size_t QUEUE_DEFAULT_SIZE = 1000;
  * Queue 类是一个模板类，用于定义队列的抽象接口。它提供了队列的基本操作，如入队（push）、
  * 出队（pop）、获取队列大小（size）、容量（capacity）、判断队列是否已满（full）和
  * 是否为空（empty）的接口。这些接口是纯虚函数，需要由派生类具体实现。
+ * - push/pop 批量地拷贝入队、移动出队，push 只对可拷贝的类型提供（见 QueueCopy）；
+ * - tryPush/tryPop 每次移动一个元素，适合 Task 这类只应该转移所有权的数据，
+ *   入队失败时不会移动参数。
  *
  * 队列是一种先进先出（FIFO）的数据结构，它允许在队列的一端（队尾）添加元素，在另一端
  * （队头）移除元素。
@@ -24,13 +46,30 @@ constexpr size_t QUEUE_DEFAULT_SIZE = 1000;
  * @note 由于这个类是抽象基类，因此不能直接实例化。必须通过继承这个类并实现其所有纯虚函数
  * 来创建具体的队列类。
  */
+template <typename _TyData, bool = std::is_copy_constructible<_TyData>::value>
+class QueueCopy
+{
+public:
+    virtual ~QueueCopy(){};
+    virtual size_t push(const _TyData *, size_t) = 0;
+};
+
+// 只能移动的类型没有批量拷贝入队的接口
 template <typename _TyData>
-class Queue
+class QueueCopy<_TyData, false>
+{
+public:
+    virtual ~QueueCopy(){};
+};
+
+template <typename _TyData>
+class Queue : public QueueCopy<_TyData>
 {
 public:
     virtual ~Queue(){};
-    virtual size_t push(const _TyData *, size_t) = 0;
     virtual size_t pop(_TyData *, size_t) = 0;
+    virtual bool tryPush(_TyData &&) = 0;
+    virtual bool tryPop(_TyData &) = 0;
     virtual size_t size() const = 0;
     virtual size_t capacity() const = 0;
     virtual bool full() const = 0;
@@ -47,11 +86,21 @@ public:
  * 申请空间大小不可改变，因此是定长的队列，通过 CAS 机制保证其无锁操作;
  * 空余一个位置用于区分队列满/空
  *
+ * 槽位是未初始化的内存，元素在入队时才构造、出队时析构，因此不要求默认构造，
+ * 只能移动的类型可以通过 emplace/tryPush 入队。可平凡拷贝的类型在批量读写时，
+ * 按环绕点拆成至多两次 memcpy。
+ *
+ * @note 槽位预留之后元素才被构造，构造过程不能抛出异常，否则队列将无法继续读写。
  */
 template <typename _TyData>
 class LockFreeQueue final : public Queue<_TyData>
 {
-    _TyData *_M_queue;
+    using Storage = typename std::aligned_storage<sizeof(_TyData), alignof(_TyData)>::type;
+    using Trivial = std::integral_constant<bool, std::is_trivially_copyable<_TyData>::value>;
+
+    static_assert(sizeof(Storage) == sizeof(_TyData), "slots must be contiguous for memcpy");
+
+    Storage *_M_queue;
     alignas(8)
         std::atomic_ulong _M_read, // 下一个可读性的位置
         _M_readable,               // 最后一个可读元素的下一个位置
@@ -61,6 +110,29 @@ class LockFreeQueue final : public Queue<_TyData>
     size_t index(size_t pos) const { return pos % _M_allocSize; }
     size_t diff(size_t pre, size_t post) const { return (post + _M_allocSize - pre) % _M_allocSize; }
 
+    _TyData *slot(size_t pos) { return reinterpret_cast<_TyData *>(&_M_queue[pos]); }
+
+    // 预留至多 nr 个可写的槽位，返回实际预留的数量，pos 为第一个槽位
+    size_t reserveWrite(size_t nr, size_t &pos);
+
+    // 按预留的顺序发布写入完成的槽位
+    void commitWrite(size_t pos, size_t nr);
+
+    size_t reserveRead(size_t nr, size_t &pos);
+
+    void commitRead(size_t pos, size_t nr);
+
+    // 可平凡拷贝的类型：按环绕点拆成至多两段连续的内存拷贝
+    void copyIn(size_t pos, const _TyData *elems, size_t nr, std::true_type);
+
+    void copyIn(size_t pos, const _TyData *elems, size_t nr, std::false_type);
+
+    void moveOut(size_t pos, _TyData *elems, size_t nr, std::true_type);
+
+    void moveOut(size_t pos, _TyData *elems, size_t nr, std::false_type);
+
+    size_t pushCopy(const _TyData *elems, size_t nr);
+
 public:
     LockFreeQueue(size_t _size = QUEUE_DEFAULT_SIZE) : _M_allocSize(_size)
     {
@@ -68,19 +140,62 @@ public:
         _M_write = 0;
         _M_readable = 0;
         _M_writeable = _M_allocSize - 1;
-        _M_queue = new _TyData[_size];
+        _M_queue = new Storage[_size];
     }
-    virtual ~LockFreeQueue() { delete[] _M_queue; }
+    virtual ~LockFreeQueue();
 
-    size_t push(const _TyData *elems, size_t nr) override;
+    LockFreeQueue(const LockFreeQueue &other) = delete;
+    LockFreeQueue &operator=(const LockFreeQueue &other) = delete;
+
+    // 批量拷贝入队。_TyData 可拷贝时覆盖 QueueCopy::push；不可拷贝时不是虚函数，
+    // 只在被调用时实例化并在编译期报错，避免把返回 0 误当作队列已满而反复重试
+    size_t push(const _TyData *elems, size_t nr)
+    {
+        static_assert(std::is_copy_constructible<_TyData>::value,
+                      "LockFreeQueue::push copies elements, use emplace/tryPush for move-only types");
+        return pushCopy(elems, nr);
+    }
 
+    // 批量移动出队
     size_t pop(_TyData *elems, size_t nr) override;
 
+    // 在队列中直接构造一个元素，队列满时返回 false
+    template <typename... ArgTp>
+    bool emplace(ArgTp &&...args)
+    {
+        size_t pos;
+        if (!reserveWrite(1, pos))
+            return false;
+        new (slot(pos)) _TyData(std::forward<ArgTp>(args)...);
+        commitWrite(pos, 1);
+        return true;
+    }
+
+    bool tryPush(_TyData &&elem) override { return emplace(std::move(elem)); }
+
+    bool tryPop(_TyData &elem) override
+    {
+        size_t pos;
+        if (!reserveRead(1, pos))
+            return false;
+        moveOut(pos, &elem, 1, Trivial());
+        commitRead(pos, 1);
+        return true;
+    }
+
     float getStress()
     {
         return (float)(size() + 1) / _M_allocSize;
     }
 
+    /**
+     * @brief 队列为空并且所有读写都已提交时，归还槽位占用的物理内存，之后写入时由内核重新分配
+     *
+     * 调用者需要保证期间没有并发的写入；仍在移出元素的读者会使本次回收被跳过。
+     * @return size_t 归还的字节数
+     */
+    size_t trim();
+
     bool full() const override
     {
         return _M_write.load(std::memory_order::memory_order_consume) ==
@@ -103,7 +218,39 @@ public:
 };
 
 template <typename _TyData>
-size_t LockFreeQueue<_TyData>::push(const _TyData *elems, size_t nr)
+LockFreeQueue<_TyData>::~LockFreeQueue()
+{
+    // 析构时不应该再有并发的读写，剩余的元素逐个析构
+    if (!std::is_trivially_destructible<_TyData>::value)
+    {
+        size_t readable = _M_readable.load(std::memory_order_acquire);
+        for (size_t pos = _M_read.load(std::memory_order_acquire); pos != readable; pos = index(pos + 1))
+        {
+            slot(pos)->~_TyData();
+        }
+    }
+    delete[] _M_queue;
+}
+
+template <typename _TyData>
+size_t LockFreeQueue<_TyData>::trim()
+{
+    // reserveRead 在移出元素之前就推进了 _M_read，只看 _M_read == _M_write 会在读者
+    // 还在访问槽位时回收页面；commitRead 按顺序推进 _M_writeable，因此它紧跟在
+    // _M_read 之后说明所有的读都已提交。先读 _M_writeable，之后提交的读只会使判断保守
+    size_t writeable = _M_writeable.load(std::memory_order_acquire);
+    size_t read = _M_read.load(std::memory_order_acquire);
+    if (index(writeable + 1) != read ||
+        read != _M_readable.load(std::memory_order_acquire) ||
+        read != _M_write.load(std::memory_order_acquire))
+        return 0;
+
+    // 槽位中没有存活的元素，只归还完全位于数组内部的页面
+    return releasePages(_M_queue, _M_allocSize * sizeof(Storage));
+}
+
+template <typename _TyData>
+size_t LockFreeQueue<_TyData>::reserveWrite(size_t nr, size_t &pos)
 {
     size_t currentWriteIndex = _M_write.load(std::memory_order::memory_order_consume);
     size_t currentWriteableIndex;
@@ -119,28 +266,27 @@ size_t LockFreeQueue<_TyData>::push(const _TyData *elems, size_t nr)
         currentWriteIndex, index(currentWriteIndex + actualNr),
         std::memory_order::memory_order_acq_rel)); // 获取可以写入的位置
 
-    // 将数据写入到对应位置
-    for (size_t i = 0; i < actualNr; i++)
-    {
-        _M_queue[index(currentWriteIndex + i)] = elems[i];
-    }
+    pos = currentWriteIndex;
+    return actualNr;
+}
 
+template <typename _TyData>
+void LockFreeQueue<_TyData>::commitWrite(size_t pos, size_t nr)
+{
     // 更新可读的最终位置
-    size_t expectReadable = currentWriteIndex;
-    size_t desiredReadable = index(expectReadable + actualNr);
+    size_t expectReadable = pos;
+    size_t desiredReadable = index(expectReadable + nr);
     while (!_M_readable.compare_exchange_strong(
         expectReadable, desiredReadable,
         std::memory_order::memory_order_acq_rel))
     {
-        expectReadable = currentWriteIndex;
+        expectReadable = pos;
         std::this_thread::yield(); // 更新失败，则暂时让出 CPU 一段时间
     }
-
-    return actualNr;
 }
 
 template <typename _TyData>
-size_t LockFreeQueue<_TyData>::pop(_TyData *elems, size_t nr)
+size_t LockFreeQueue<_TyData>::reserveRead(size_t nr, size_t &pos)
 {
     size_t currentReadIndex = _M_read.load(std::memory_order::memory_order_consume);
     size_t currentReadableIndex;
@@ -156,16 +302,17 @@ size_t LockFreeQueue<_TyData>::pop(_TyData *elems, size_t nr)
         currentReadIndex, index(currentReadIndex + actualNr),
         std::memory_order::memory_order_acq_rel)); // 获取可以读取的位置
 
-    // 将数据写入到对应位置
-    for (size_t i = 0; i < actualNr; i++)
-    {
-        elems[i] = _M_queue[index(currentReadIndex + i)];
-    }
+    pos = currentReadIndex;
+    return actualNr;
+}
 
+template <typename _TyData>
+void LockFreeQueue<_TyData>::commitRead(size_t pos, size_t nr)
+{
     // 更新可写的最终位置
-    size_t expectWriteable = index(currentReadIndex + _M_allocSize - 1);
+    size_t expectWriteable = index(pos + _M_allocSize - 1);
     size_t stashWriteable = expectWriteable;
-    size_t desiredWriteable = index(expectWriteable + actualNr);
+    size_t desiredWriteable = index(expectWriteable + nr);
     while (!_M_writeable.compare_exchange_strong(
         expectWriteable, desiredWriteable,
         std::memory_order::memory_order_acq_rel))
@@ -173,10 +320,405 @@ size_t LockFreeQueue<_TyData>::pop(_TyData *elems, size_t nr)
         expectWriteable = stashWriteable;
         std::this_thread::yield(); // 更新失败，则暂时让出 CPU 一段时间
     }
+}
+
+template <typename _TyData>
+void LockFreeQueue<_TyData>::copyIn(size_t pos, const _TyData *elems, size_t nr, std::true_type)
+{
+    size_t first = std::min(nr, _M_allocSize - pos);
+    memcpy(slot(pos), elems, first * sizeof(_TyData));
+    if (nr > first)
+        memcpy(slot(0), elems + first, (nr - first) * sizeof(_TyData));
+}
+
+template <typename _TyData>
+void LockFreeQueue<_TyData>::copyIn(size_t pos, const _TyData *elems, size_t nr, std::false_type)
+{
+    for (size_t i = 0; i < nr; i++)
+    {
+        new (slot(pos)) _TyData(elems[i]);
+        if (++pos == _M_allocSize)
+            pos = 0;
+    }
+}
+
+template <typename _TyData>
+void LockFreeQueue<_TyData>::moveOut(size_t pos, _TyData *elems, size_t nr, std::true_type)
+{
+    size_t first = std::min(nr, _M_allocSize - pos);
+    memcpy(elems, slot(pos), first * sizeof(_TyData));
+    if (nr > first)
+        memcpy(elems + first, slot(0), (nr - first) * sizeof(_TyData));
+}
+
+template <typename _TyData>
+void LockFreeQueue<_TyData>::moveOut(size_t pos, _TyData *elems, size_t nr, std::false_type)
+{
+    for (size_t i = 0; i < nr; i++)
+    {
+        _TyData *elem = slot(pos);
+        elems[i] = std::move(*elem);
+        elem->~_TyData();
+        if (++pos == _M_allocSize)
+            pos = 0;
+    }
+}
+
+template <typename _TyData>
+size_t LockFreeQueue<_TyData>::pushCopy(const _TyData *elems, size_t nr)
+{
+    size_t pos;
+    size_t actualNr = reserveWrite(nr, pos);
+    if (!actualNr)
+        return 0;
+
+    // 将数据写入到对应位置
+    copyIn(pos, elems, actualNr, Trivial());
+    commitWrite(pos, actualNr);
+    return actualNr;
+}
 
+template <typename _TyData>
+size_t LockFreeQueue<_TyData>::pop(_TyData *elems, size_t nr)
+{
+    size_t pos;
+    size_t actualNr = reserveRead(nr, pos);
+    if (!actualNr)
+        return 0;
+
+    // 将数据移动到调用者的数组中
+    moveOut(pos, elems, actualNr, Trivial());
+    commitRead(pos, actualNr);
     return actualNr;
 }
 
+/**
+ * @template _TyData 队列中存储的数据类型。
+ * @class SpscQueue
+ * @brief 单生产者单消费者的无等待队列，继承自 Queue 模板类。
+ *
+ * 只允许一个线程调用 push，一个线程调用 pop，因此读写位置各自只有一个写者，
+ * 不需要任何 CAS 操作，每次操作都在有限步内完成。
+ * 读写位置单调递增，分别放在不同的缓存行中；生产者缓存了最近一次看到的读位置，
+ * 消费者缓存了最近一次看到的写位置，只有缓存的值表明队列满/空时才重新读取对方的位置，
+ * 从而减少缓存行在两个核心之间的来回传递。
+ *
+ * 与 LockFreeQueue 相同，槽位是未初始化的内存，只能移动的类型通过 tryPush 入队。
+ * 线程池的共享队列由全部工作线程消费，因此它不能作为 BasicThreadManager 的 _Queue 策略。
+ */
+template <typename _TyData>
+class SpscQueue final : public Queue<_TyData>
+{
+    using Storage = typename std::aligned_storage<sizeof(_TyData), alignof(_TyData)>::type;
+
+    Storage *_M_queue;
+    size_t _M_allocSize;
+
+    // 读写两端分别填充到独立的缓存行，避免伪共享
+    char _M_pad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> _M_read; // 下一个可读的位置，只由消费者修改
+    size_t _M_cachedWrite;       // 消费者缓存的写位置
+    char _M_pad1[CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+    std::atomic<size_t> _M_write; // 下一个可写的位置，只由生产者修改
+    size_t _M_cachedRead;         // 生产者缓存的读位置
+    char _M_pad2[CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+
+    size_t index(size_t pos) const { return pos % _M_allocSize; }
+
+    _TyData *slot(size_t pos) { return reinterpret_cast<_TyData *>(&_M_queue[index(pos)]); }
+
+    // 移出一个元素并析构槽位中的对象
+    void moveOut(size_t pos, _TyData &elem)
+    {
+        _TyData *data = slot(pos);
+        elem = std::move(*data);
+        data->~_TyData();
+    }
+
+public:
+    SpscQueue(size_t _size = QUEUE_DEFAULT_SIZE)
+        : _M_allocSize(_size ? _size : 1), _M_read(0), _M_cachedWrite(0),
+          _M_write(0), _M_cachedRead(0)
+    {
+        _M_queue = new Storage[_M_allocSize];
+    }
+    virtual ~SpscQueue()
+    {
+        // 析构时不应该再有并发的读写，剩余的元素逐个析构
+        size_t write = _M_write.load(std::memory_order_acquire);
+        for (size_t pos = _M_read.load(std::memory_order_acquire); pos != write; pos++)
+        {
+            slot(pos)->~_TyData();
+        }
+        delete[] _M_queue;
+    }
+
+    SpscQueue(const SpscQueue &other) = delete;
+    SpscQueue &operator=(const SpscQueue &other) = delete;
+
+    // 批量拷贝入队，只对可拷贝的类型提供，参见 LockFreeQueue::push
+    size_t push(const _TyData *elems, size_t nr)
+    {
+        static_assert(std::is_copy_constructible<_TyData>::value,
+                      "SpscQueue::push copies elements, use tryPush for move-only types");
+        size_t write = _M_write.load(std::memory_order_relaxed);
+        if (write - _M_cachedRead + nr > _M_allocSize)
+        {
+            _M_cachedRead = _M_read.load(std::memory_order_acquire);
+        }
+        size_t actualNr = std::min(nr, _M_allocSize - (write - _M_cachedRead));
+
+        for (size_t i = 0; i < actualNr; i++)
+        {
+            new (slot(write + i)) _TyData(elems[i]);
+        }
+        _M_write.store(write + actualNr, std::memory_order_release);
+        return actualNr;
+    }
+
+    size_t pop(_TyData *elems, size_t nr) override
+    {
+        size_t read = _M_read.load(std::memory_order_relaxed);
+        if (_M_cachedWrite - read < nr)
+        {
+            _M_cachedWrite = _M_write.load(std::memory_order_acquire);
+        }
+        size_t actualNr = std::min(nr, _M_cachedWrite - read);
+
+        for (size_t i = 0; i < actualNr; i++)
+        {
+            moveOut(read + i, elems[i]);
+        }
+        _M_read.store(read + actualNr, std::memory_order_release);
+        return actualNr;
+    }
+
+    bool tryPush(_TyData &&elem) override
+    {
+        size_t write = _M_write.load(std::memory_order_relaxed);
+        if (write - _M_cachedRead >= _M_allocSize)
+        {
+            _M_cachedRead = _M_read.load(std::memory_order_acquire);
+            if (write - _M_cachedRead >= _M_allocSize)
+                return false;
+        }
+        new (slot(write)) _TyData(std::move(elem));
+        _M_write.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(_TyData &elem) override
+    {
+        size_t read = _M_read.load(std::memory_order_relaxed);
+        if (_M_cachedWrite == read)
+        {
+            _M_cachedWrite = _M_write.load(std::memory_order_acquire);
+            if (_M_cachedWrite == read)
+                return false;
+        }
+        moveOut(read, elem);
+        _M_read.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool full() const override { return size() >= _M_allocSize; }
+
+    bool empty() const override
+    {
+        return _M_read.load(std::memory_order_acquire) ==
+               _M_write.load(std::memory_order_acquire);
+    }
+
+    size_t size() const override
+    {
+        size_t read = _M_read.load(std::memory_order_acquire);
+        return _M_write.load(std::memory_order_acquire) - read;
+    }
+
+    size_t capacity() const override { return _M_allocSize; }
+};
+
+/**
+ * @template _TyData 队列中存储的数据类型。
+ * @class MpscQueue
+ * @brief 多生产者单消费者队列，继承自 Queue 模板类。
+ *
+ * 生产者通过 CAS 在写位置上预留连续的槽位，写入数据后将槽位的序号设置为「位置 + 1」，
+ * 表示该槽位已经可读；消费者只有一个，按顺序检查槽位序号，读取后直接推进读位置，
+ * 不需要任何 CAS 操作。适合作为每个工作线程的收件箱。
+ *
+ * 槽位中的数据是未初始化的内存，写入时构造、读取时析构，只能移动的类型通过 tryPush 入队。
+ * 同样只允许一个消费者，不能作为 BasicThreadManager 的 _Queue 策略。
+ */
+template <typename _TyData>
+class MpscQueue final : public Queue<_TyData>
+{
+    using Storage = typename std::aligned_storage<sizeof(_TyData), alignof(_TyData)>::type;
+
+    struct Slot
+    {
+        std::atomic<size_t> seq; // 等于「位置 + 1」时，槽位中的数据可读
+        Storage data;
+
+        Slot() : seq(0) {}
+
+        _TyData *get() { return reinterpret_cast<_TyData *>(&data); }
+    };
+
+    Slot *_M_queue;
+    size_t _M_allocSize;
+
+    char _M_pad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> _M_read; // 下一个可读的位置，只由消费者修改
+    char _M_pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+    std::atomic<size_t> _M_write; // 下一个可写的位置，由生产者通过 CAS 预留
+    char _M_pad2[CACHE_LINE_SIZE - sizeof(size_t)];
+
+    size_t index(size_t pos) const { return pos % _M_allocSize; }
+
+    // 预留至多 nr 个连续的槽位，返回实际预留的数量，write 为第一个槽位的位置
+    size_t reserve(size_t nr, size_t &write)
+    {
+        size_t actualNr;
+        write = _M_write.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            // 读位置之前的槽位都已经被消费者读取完毕，可以安全地覆盖
+            size_t read = _M_read.load(std::memory_order_acquire);
+            // 写位置可能是旧值，而消费者已经读到了更新的位置，此时重新读取写位置
+            if (write < read)
+            {
+                write = _M_write.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (write - read >= _M_allocSize)
+                return 0; // 如果队列满了，返回 0，无法写入
+            actualNr = std::min(nr, _M_allocSize - (write - read));
+            if (_M_write.compare_exchange_weak(
+                    write, write + actualNr,
+                    std::memory_order_acq_rel, std::memory_order_relaxed))
+                return actualNr;
+        }
+    }
+
+    // 移出一个元素并析构槽位中的对象
+    static void moveOut(Slot &slot, _TyData &elem)
+    {
+        elem = std::move(*slot.get());
+        slot.get()->~_TyData();
+    }
+
+public:
+    MpscQueue(size_t _size = QUEUE_DEFAULT_SIZE)
+        : _M_allocSize(_size ? _size : 1), _M_read(0), _M_write(0)
+    {
+        _M_queue = new Slot[_M_allocSize];
+    }
+    virtual ~MpscQueue()
+    {
+        // 析构时不应该再有并发的读写，已经写入完成的元素逐个析构
+        for (size_t pos = _M_read.load(std::memory_order_acquire);; pos++)
+        {
+            Slot &slot = _M_queue[index(pos)];
+            if (slot.seq.load(std::memory_order_acquire) != pos + 1)
+                break;
+            slot.get()->~_TyData();
+        }
+        delete[] _M_queue;
+    }
+
+    MpscQueue(const MpscQueue &other) = delete;
+    MpscQueue &operator=(const MpscQueue &other) = delete;
+
+    // 批量拷贝入队，只对可拷贝的类型提供，参见 LockFreeQueue::push
+    size_t push(const _TyData *elems, size_t nr)
+    {
+        static_assert(std::is_copy_constructible<_TyData>::value,
+                      "MpscQueue::push copies elements, use tryPush for move-only types");
+        size_t write;
+        size_t actualNr = reserve(nr, write);
+
+        for (size_t i = 0; i < actualNr; i++)
+        {
+            Slot &slot = _M_queue[index(write + i)];
+            new (slot.get()) _TyData(elems[i]);
+            slot.seq.store(write + i + 1, std::memory_order_release);
+        }
+        return actualNr;
+    }
+
+    size_t pop(_TyData *elems, size_t nr) override
+    {
+        size_t read = _M_read.load(std::memory_order_relaxed);
+        size_t actualNr = 0;
+
+        // 只读取连续的、已经写入完成的槽位，遇到尚未写完的槽位即停止
+        while (actualNr < nr)
+        {
+            Slot &slot = _M_queue[index(read + actualNr)];
+            if (slot.seq.load(std::memory_order_acquire) != read + actualNr + 1)
+                break;
+            moveOut(slot, elems[actualNr]);
+            actualNr++;
+        }
+        if (actualNr)
+            _M_read.store(read + actualNr, std::memory_order_release);
+        return actualNr;
+    }
+
+    bool tryPush(_TyData &&elem) override
+    {
+        size_t write;
+        if (!reserve(1, write))
+            return false;
+        Slot &slot = _M_queue[index(write)];
+        new (slot.get()) _TyData(std::move(elem));
+        slot.seq.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(_TyData &elem) override
+    {
+        size_t read = _M_read.load(std::memory_order_relaxed);
+        Slot &slot = _M_queue[index(read)];
+        if (slot.seq.load(std::memory_order_acquire) != read + 1)
+            return false;
+        moveOut(slot, elem);
+        _M_read.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool full() const override { return size() >= _M_allocSize; }
+
+    bool empty() const override
+    {
+        return _M_read.load(std::memory_order_acquire) ==
+               _M_write.load(std::memory_order_acquire);
+    }
+
+    size_t size() const override
+    {
+        size_t read = _M_read.load(std::memory_order_acquire);
+        return _M_write.load(std::memory_order_acquire) - read;
+    }
+
+    size_t capacity() const override { return _M_allocSize; }
+
+    /**
+     * @brief 队列为空时归还槽位数组中完整的页面，返回归还的字节数
+     * @note 调用者需要保证期间没有生产者，消费者可以并发地读取
+     */
+    size_t trim()
+    {
+        // 消费者在移出元素之后才推进 _M_read，两者相等说明没有存活的元素，也没有正在进行的读；
+        // 归还的页面重新读取时为 0，不会等于任何「位置 + 1」，消费者仍然认为槽位不可读
+        if (_M_read.load(std::memory_order_acquire) != _M_write.load(std::memory_order_acquire))
+            return 0;
+        return releasePages(_M_queue, _M_allocSize * sizeof(Slot));
+    }
+};
+
 /**
  * 变长队列，当需要扩容队列的时候，申请一个新的定长队列；
  * 然后将写任务指向新队列，而原队列只负责读；
@@ -202,10 +744,20 @@ public:
         delete newPtr;
     }
 
-    size_t push(const _TyData *elems, size_t nr = 1) override { return writePtr->push(elems, nr); }
+    // 批量拷贝入队，只对可拷贝的类型提供，参见 LockFreeQueue::push
+    size_t push(const _TyData *elems, size_t nr = 1)
+    {
+        static_assert(std::is_copy_constructible<_TyData>::value,
+                      "DynamicQueue::push copies elements, use tryPush for move-only types");
+        return writePtr->push(elems, nr);
+    }
 
     size_t pop(_TyData *elems, size_t nr = 1) override { return readPtr->pop(elems, nr); }
 
+    bool tryPush(_TyData &&elem) override { return writePtr->tryPush(std::move(elem)); }
+
+    bool tryPop(_TyData &elem) override { return readPtr->tryPop(elem); }
+
     /*
      * 这个函数只能由控制者使用，其他线程不能调用
      * 此外，这个大小修改只适用于线程池，因为队列中的元素不断被消耗；
@@ -213,9 +765,9 @@ public:
      */
     bool resize(size_t _size)
     {
-        if (_size < ((curPtr->capicity() * 3) >> 1) || newPtr)
+        if (_size < ((curPtr->capacity() * 3) >> 1) || newPtr)
             return false;
-        newPtr = new LockFreeQueue<_TyData>(_size);
+        newPtr = new _BaseQueue(_size);
         writePtr = newPtr;
         while (curPtr->size())
         {
@@ -234,6 +786,8 @@ public:
         return true;
     }
 
+    bool full() const override { return writePtr->full(); }
+
     bool empty() const override { return curPtr->empty(); }
 
     size_t size() const override { return curPtr->size(); }
@@ -241,4 +795,25 @@ public:
     size_t capacity() const override { return curPtr->capacity(); }
 };
 
+// 队列是否只允许一个消费者，这样的队列不能作为线程池的共享队列
+template <typename _Queue>
+struct SingleConsumer : std::false_type
+{
+};
+
+template <typename _TyData>
+struct SingleConsumer<SpscQueue<_TyData>> : std::true_type
+{
+};
+
+template <typename _TyData>
+struct SingleConsumer<MpscQueue<_TyData>> : std::true_type
+{
+};
+
+template <typename _TyData, typename _BaseQueue>
+struct SingleConsumer<DynamicQueue<_TyData, _BaseQueue>> : SingleConsumer<_BaseQueue>
+{
+};
+
 #endif
\ No newline at end of file
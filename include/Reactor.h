@@ -0,0 +1,201 @@
+/**
+ * @file Reactor.h
+ * @author Xu.Cao
+ * @details
+ *  本文件提供线程池与 epoll 事件循环之间的衔接：
+ * - EventNotifier：对 eventfd 的封装，可以注册到任意 epoll 循环中，用于跨线程唤醒；
+ * - CompletionQueue：任务的结果放入无锁队列，并通过 EventNotifier 通知外部的事件循环，
+ *   事件循环被唤醒后一次取出全部结果；
+ * - Reactor：内置的事件循环，注册文件描述符和回调后，就绪事件直接作为任务提交到线程池。
+ *   文件描述符使用 EPOLLONESHOT 注册，回调执行结束后才重新监听，因此同一个描述符的
+ *   回调不会并发执行。线程池暂停时回调推迟到恢复运行后执行，不会占用事件循环。
+ */
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include "Task.h"
+#include "Latch.h"
+#include "Queue.h"
+
+/**
+ * @class EventNotifier
+ * @brief 非阻塞的 eventfd，notify 累加计数，consume 读出并清零
+ */
+class EventNotifier final
+{
+    int _M_fd;
+
+public:
+    EventNotifier();
+
+    ~EventNotifier();
+
+    EventNotifier(const EventNotifier &other) = delete;
+    EventNotifier &operator=(const EventNotifier &other) = delete;
+
+    bool valid() const { return _M_fd >= 0; }
+
+    // 用于注册到 epoll 的文件描述符，可读表示有通知
+    int fd() const { return _M_fd; }
+
+    bool notify(uint64_t nr = 1);
+
+    // 读出累计的通知次数，没有通知时返回 0
+    uint64_t consume();
+};
+
+/**
+ * @template _TyData 结果的类型
+ * @class CompletionQueue
+ * @brief 将线程池中产生的结果送回外部的事件循环
+ *
+ * 只有队列从空变为非空时才写 eventfd，事件循环在 fd() 可读时调用 drain 取出全部结果。
+ */
+template <typename _TyData>
+class CompletionQueue final
+{
+    MpscQueue<_TyData> _M_results;
+    EventNotifier _M_notifier;
+    std::atomic<bool> _M_signaled; // 已经通知、但事件循环还没有开始取出
+
+public:
+    explicit CompletionQueue(size_t size = QUEUE_DEFAULT_SIZE)
+        : _M_results(size), _M_signaled(false) {}
+
+    bool valid() const { return _M_notifier.valid(); }
+
+    int fd() const { return _M_notifier.fd(); }
+
+    /**
+     * @brief 放入一个结果，可以在任意线程中调用
+     * @return bool 队列已满时返回 false
+     */
+    bool post(const _TyData &result)
+    {
+        if (!_M_results.push(&result, 1))
+            return false;
+        if (!_M_signaled.exchange(true, std::memory_order_acq_rel))
+            _M_notifier.notify();
+        return true;
+    }
+
+    /**
+     * @brief 取出全部结果并依次调用 func，只能在一个线程（事件循环）中调用
+     * @return size_t 取出的结果数量
+     */
+    template <typename _Fn>
+    size_t drain(_Fn &&func)
+    {
+        // 先清除通知再取出，之后放入的结果会再次通知
+        _M_notifier.consume();
+        _M_signaled.exchange(false, std::memory_order_acq_rel);
+
+        size_t nr = 0;
+        _TyData result;
+        while (_M_results.pop(&result, 1))
+        {
+            func(result);
+            nr++;
+        }
+        return nr;
+    }
+};
+
+/**
+ * @class Reactor
+ * @brief 在独立线程中运行 epoll，将就绪事件作为任务提交到线程池
+ */
+class Reactor final
+{
+public:
+    using Callback = std::function<void(int fd, uint32_t events)>;
+
+private:
+    struct Handler
+    {
+        int fd;
+        uint32_t events;             // 注册时关心的事件
+        std::atomic<uint32_t> ready; // 本次就绪的事件
+        std::atomic<int> refs;       // 注册表和正在执行的回调各持有一个引用
+        std::atomic<bool> removed;   // 只在持有 _M_mutex 时修改
+        Callback callback;
+        Reactor *reactor;
+    };
+
+    static constexpr int EVENT_BATCH = 64;
+
+    int _M_epoll;
+    EventNotifier _M_wakeup; // 用于唤醒事件循环，处理移除和停止
+    std::atomic<bool> _M_stop;
+    std::thread _M_loop;
+
+    std::unordered_map<int, Handler *> _M_handlers;
+    std::vector<Handler *> _M_retired; // 已经移除、等待事件循环释放的注册
+    std::mutex _M_mutex;
+
+    // 所使用的线程池，以及向它提交任务的函数；线程池是模板，这里擦除类型。
+    // 线程池暂停时推迟，只有终止时失败
+    void *_M_manager;
+    bool (*_M_post)(void *manager, Task &&task);
+    Latch _M_inFlight; // 已经提交但尚未执行完成的回调
+
+    template <typename _Manager>
+    static bool postTo(void *manager, Task &&task)
+    {
+        return static_cast<_Manager *>(manager)->postOrDefer(std::move(task));
+    }
+
+    void init();
+
+    void run();
+
+    static void dispatch(void *arg);
+
+    static void release(Handler *handler);
+
+public:
+    /**
+     * @template _Manager 提供 bool postOrDefer(Task &&) 的线程池，例如 ThreadManager
+     * @note 析构时会等待正在执行和被推迟的回调，因此需要先于线程池析构，
+     *  并且不要在线程池暂停期间析构
+     */
+    template <typename _Manager>
+    explicit Reactor(_Manager &manager)
+        : _M_epoll(-1), _M_stop(false), _M_manager(&manager),
+          _M_post(&Reactor::postTo<_Manager>)
+    {
+        init();
+    }
+
+    // 停止事件循环，等待正在执行的回调结束
+    ~Reactor();
+
+    Reactor(const Reactor &other) = delete;
+    Reactor &operator=(const Reactor &other) = delete;
+
+    bool valid() const { return _M_epoll >= 0 && _M_wakeup.valid(); }
+
+    /**
+     * @brief 监听文件描述符，事件就绪时在线程池中执行回调
+     *
+     * @param events epoll 事件，例如 EPOLLIN；EPOLLONESHOT 会被自动加上
+     * @return bool 描述符已经注册或者 epoll_ctl 失败时返回 false
+     */
+    bool add(int fd, uint32_t events, Callback callback);
+
+    /**
+     * @brief 停止监听，返回后不会再有新的回调开始执行，但已经开始的回调可能尚未结束
+     */
+    bool remove(int fd);
+
+    size_t size();
+};
+
+#endif
@@ -0,0 +1,528 @@
+/**
+ * @file ShmQueue.h
+ * @author Xu.Cao
+ * @details
+ *  本文件提供跨进程的共享内存队列，用于本机的零拷贝进程间通信：
+ * - ShmRegion：对 memfd/shm_open 映射的封装，可以按文件描述符或者名字在其他进程中打开；
+ * - ShmQueue：位于共享内存中的多生产者多消费者有界队列，只保存可平凡拷贝的消息，
+ *   内存布局中只有偏移没有指针，因此各个进程可以映射到不同的地址；
+ *   消费者在共享的 futex 上睡眠，生产者写入后按需唤醒；
+ * - ShmIngress：在独立线程中从 ShmQueue 中批量取出消息，作为任务提交到线程池处理。
+ *
+ * @note 生产者在写入的过程中崩溃时，它预留的槽位将无法被读取，之后的消息也会被阻塞。
+ */
+#ifndef SHM_QUEUE_H
+#define SHM_QUEUE_H
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include "Task.h"
+#include "Latch.h"
+#include "Queue.h"
+#include "Futex.h"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "atomics in shared memory must be lock-free");
+
+/**
+ * @class ShmRegion
+ * @brief 一段共享内存映射，析构时解除映射并关闭文件描述符
+ */
+class ShmRegion final
+{
+    int _M_fd;
+    void *_M_addr;
+    size_t _M_size;
+
+    bool map(int fd);
+
+public:
+    ShmRegion() : _M_fd(-1), _M_addr(nullptr), _M_size(0) {}
+
+    ~ShmRegion() { reset(); }
+
+    ShmRegion(const ShmRegion &other) = delete;
+    ShmRegion &operator=(const ShmRegion &other) = delete;
+
+    /**
+     * @brief 创建并映射一段共享内存，内容全部为零
+     *
+     * @param name 为空时使用 memfd，只能通过文件描述符共享（fork 继承或者 SCM_RIGHTS 传递）；
+     *  否则使用 shm_open，名字以 '/' 开头，已经存在时失败
+     */
+    bool create(size_t size, const char *name = nullptr);
+
+    // 按名字打开 shm_open 创建的共享内存
+    bool open(const char *name);
+
+    // 映射其他进程传来的文件描述符，内部会复制一份，调用者仍然持有 fd
+    bool attach(int fd);
+
+    void reset();
+
+    // 删除 shm_open 创建的名字，已经打开的映射不受影响
+    static bool unlink(const char *name);
+
+    bool valid() const { return _M_addr != nullptr; }
+
+    int fd() const { return _M_fd; }
+
+    void *data() const { return _M_addr; }
+
+    size_t size() const { return _M_size; }
+};
+
+/**
+ * @template _TyData 消息的类型，必须可以平凡拷贝，并且在各个进程中具有相同的布局
+ * @class ShmQueue
+ * @brief 共享内存中的多生产者多消费者有界队列
+ *
+ * 每个槽位带有一个序号：序号等于写位置时可写，等于写位置加一时可读，
+ * 读取后序号增加一圈，因此生产者和消费者只需要对各自的位置做 CAS。
+ * 容量会被向上取整为 2 的幂。
+ */
+template <typename _TyData>
+class ShmQueue final
+{
+    static_assert(std::is_trivially_copyable<_TyData>::value,
+                  "messages in shared memory must be trivially copyable");
+
+    static constexpr uint32_t SHM_MAGIC = 0x53514D51; // "QMQS"
+
+    struct Header
+    {
+        std::atomic<uint32_t> magic; // 初始化完成后才写入
+        uint32_t elemSize;
+        uint64_t capacity;
+        char pad0[CACHE_LINE_SIZE - 16];
+        std::atomic<uint64_t> write;
+        char pad1[CACHE_LINE_SIZE - 8];
+        std::atomic<uint64_t> read;
+        char pad2[CACHE_LINE_SIZE - 8];
+        std::atomic<uint32_t> signal;   // 消费者在这个字上睡眠，唤醒时递增
+        std::atomic<uint32_t> sleepers; // 正在睡眠或准备睡眠的消费者数量
+    };
+
+    struct Slot
+    {
+        std::atomic<uint64_t> seq;
+        _TyData data;
+    };
+
+    static constexpr size_t SLOT_OFFSET = (sizeof(Header) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+    ShmRegion _M_region;
+    Header *_M_header;
+    Slot *_M_slots;
+    uint64_t _M_mask;
+
+    bool bind();
+
+    bool pushOne(const _TyData &elem);
+
+public:
+    ShmQueue() : _M_header(nullptr), _M_slots(nullptr), _M_mask(0) {}
+
+    ShmQueue(const ShmQueue &other) = delete;
+    ShmQueue &operator=(const ShmQueue &other) = delete;
+
+    // 创建一个新的队列，name 的含义与 ShmRegion::create 相同
+    bool create(size_t capacity = QUEUE_DEFAULT_SIZE, const char *name = nullptr);
+
+    bool open(const char *name);
+
+    bool attach(int fd);
+
+    bool valid() const { return _M_header != nullptr; }
+
+    // 用于传递给其他进程的文件描述符
+    int fd() const { return _M_region.fd(); }
+
+    // 放入一条消息，队列满时返回 false
+    bool tryPush(const _TyData &elem)
+    {
+        if (!pushOne(elem))
+            return false;
+        notify(1);
+        return true;
+    }
+
+    // 批量放入消息，只在最后唤醒一次消费者，返回实际放入的数量
+    size_t push(const _TyData *elems, size_t nr)
+    {
+        size_t actualNr = 0;
+        while (actualNr < nr && pushOne(elems[actualNr]))
+            actualNr++;
+        if (actualNr)
+            notify(actualNr);
+        return actualNr;
+    }
+
+    bool tryPop(_TyData &elem);
+
+    size_t pop(_TyData *elems, size_t nr)
+    {
+        size_t actualNr = 0;
+        while (actualNr < nr && tryPop(elems[actualNr]))
+            actualNr++;
+        return actualNr;
+    }
+
+    // 唤醒至多 nr 个睡眠的消费者，没有消费者睡眠时不进入内核
+    void notify(size_t nr = 1)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_M_header->sleepers.load(std::memory_order_relaxed))
+        {
+            _M_header->signal.fetch_add(1, std::memory_order_release);
+            futexWake(&_M_header->signal, nr < INT32_MAX ? (int)nr : INT32_MAX, true);
+        }
+    }
+
+    // 无条件唤醒全部消费者，用于停止消费
+    void notifyAll()
+    {
+        _M_header->signal.fetch_add(1);
+        futexWake(&_M_header->signal, INT32_MAX, true);
+    }
+
+    /**
+     * @brief 队列为空并且 stop 返回 false 时睡眠，直到有新消息、被唤醒或者超时
+     * @return bool 返回时队列是否非空
+     */
+    template <typename _Pred>
+    bool waitFor(std::chrono::nanoseconds timeout, _Pred &&stop)
+    {
+        uint32_t signal = _M_header->signal.load(std::memory_order_acquire);
+        _M_header->sleepers.fetch_add(1);
+        if (empty() && !stop())
+            futexWaitFor(&_M_header->signal, signal, timeout, true);
+        _M_header->sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return !empty();
+    }
+
+    bool waitFor(std::chrono::nanoseconds timeout)
+    {
+        return waitFor(timeout, []
+                       { return false; });
+    }
+
+    bool empty() const
+    {
+        return _M_header->read.load(std::memory_order_acquire) ==
+               _M_header->write.load(std::memory_order_acquire);
+    }
+
+    size_t size() const
+    {
+        uint64_t read = _M_header->read.load(std::memory_order_acquire);
+        uint64_t write = _M_header->write.load(std::memory_order_acquire);
+        return write > read ? write - read : 0;
+    }
+
+    size_t capacity() const { return _M_mask + 1; }
+};
+
+template <typename _TyData>
+constexpr uint32_t ShmQueue<_TyData>::SHM_MAGIC;
+
+template <typename _TyData>
+constexpr size_t ShmQueue<_TyData>::SLOT_OFFSET;
+
+template <typename _TyData>
+bool ShmQueue<_TyData>::create(size_t capacity, const char *name)
+{
+    _M_header = nullptr;
+
+    // 向上取整后的容量加上头部不能超过 size_t，否则取整会溢出为 0，申请的大小也会回绕
+    const size_t maxCapacity = (SIZE_MAX - SLOT_OFFSET) / sizeof(Slot);
+    uint64_t allocSize = 1;
+    if (capacity <= maxCapacity)
+    {
+        while (allocSize < capacity)
+            allocSize <<= 1;
+    }
+    if (capacity > maxCapacity || allocSize > maxCapacity)
+    {
+        _M_region.reset();
+        return false;
+    }
+
+    if (!_M_region.create(SLOT_OFFSET + allocSize * sizeof(Slot), name))
+        return false;
+
+    // 新建的共享内存全部为零，只需要设置非零的字段
+    Header *header = static_cast<Header *>(_M_region.data());
+    Slot *slots = reinterpret_cast<Slot *>(static_cast<char *>(_M_region.data()) + SLOT_OFFSET);
+    header->elemSize = sizeof(_TyData);
+    header->capacity = allocSize;
+    for (uint64_t i = 0; i < allocSize; i++)
+        slots[i].seq.store(i, std::memory_order_relaxed);
+    header->magic.store(SHM_MAGIC, std::memory_order_release);
+
+    return bind();
+}
+
+template <typename _TyData>
+bool ShmQueue<_TyData>::open(const char *name)
+{
+    _M_header = nullptr;
+    return _M_region.open(name) && bind();
+}
+
+template <typename _TyData>
+bool ShmQueue<_TyData>::attach(int fd)
+{
+    _M_header = nullptr;
+    return _M_region.attach(fd) && bind();
+}
+
+template <typename _TyData>
+bool ShmQueue<_TyData>::bind()
+{
+    // 检查布局是否与本进程的消息类型一致；容量来自共享内存，不能信任，
+    // 按除法比较，避免 capacity * sizeof(Slot) 溢出之后通过检查
+    Header *header = static_cast<Header *>(_M_region.data());
+    if (_M_region.size() < SLOT_OFFSET ||
+        header->magic.load(std::memory_order_acquire) != SHM_MAGIC ||
+        header->elemSize != sizeof(_TyData) ||
+        header->capacity == 0 ||
+        (header->capacity & (header->capacity - 1)) ||
+        header->capacity > (_M_region.size() - SLOT_OFFSET) / sizeof(Slot))
+    {
+        _M_region.reset();
+        return false;
+    }
+
+    _M_header = header;
+    _M_slots = reinterpret_cast<Slot *>(static_cast<char *>(_M_region.data()) + SLOT_OFFSET);
+    _M_mask = header->capacity - 1;
+    return true;
+}
+
+template <typename _TyData>
+bool ShmQueue<_TyData>::pushOne(const _TyData &elem)
+{
+    uint64_t pos = _M_header->write.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot &slot = _M_slots[pos & _M_mask];
+        int64_t diff = (int64_t)(slot.seq.load(std::memory_order_acquire) - pos);
+        if (diff == 0)
+        {
+            if (_M_header->write.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                memcpy(&slot.data, &elem, sizeof(_TyData));
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // 槽位还没有被读取，队列已满
+        }
+        else
+        {
+            pos = _M_header->write.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename _TyData>
+bool ShmQueue<_TyData>::tryPop(_TyData &elem)
+{
+    uint64_t pos = _M_header->read.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot &slot = _M_slots[pos & _M_mask];
+        int64_t diff = (int64_t)(slot.seq.load(std::memory_order_acquire) - (pos + 1));
+        if (diff == 0)
+        {
+            if (_M_header->read.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                memcpy(&elem, &slot.data, sizeof(_TyData));
+                // 序号增加一圈，供下一轮的生产者写入
+                slot.seq.store(pos + _M_mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // 槽位还没有写入完成，队列为空
+        }
+        else
+        {
+            pos = _M_header->read.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @template _TyData 消息的类型
+ * @class ShmIngress
+ * @brief 将共享内存队列中的消息交给线程池处理
+ *
+ * 独立的线程在队列上等待，每次取出至多 INGRESS_BATCH 条消息，作为一个任务提交到线程池，
+ * 因此同一批消息按顺序处理，不同批次之间可能并发。
+ * 批次在构造时一次分配 INGRESS_BATCHES 个，处理完成后归还复用；全部在途时接收线程等待，
+ * 消息留在共享内存中，线程池暂停或者处理不过来时不会无限制地取出消息。
+ * 析构时停止接收，等待已经提交的批次处理完成，队列中剩余的消息保留在共享内存中。
+ */
+template <typename _TyData>
+class ShmIngress final
+{
+public:
+    using Handler = std::function<void(const _TyData &)>;
+
+    static constexpr size_t INGRESS_BATCH = 64;
+    static constexpr size_t INGRESS_BATCHES = 16;
+
+private:
+    struct Batch
+    {
+        ShmIngress *ingress;
+        size_t nr;
+        _TyData items[INGRESS_BATCH];
+    };
+
+    ShmQueue<_TyData> &_M_queue;
+    Handler _M_handler;
+    std::atomic<bool> _M_stop;
+    std::atomic<size_t> _M_received;
+
+    std::unique_ptr<Batch[]> _M_batches;
+    MpscQueue<Batch *> _M_free;        // 空闲的批次，工作线程处理完成后归还，只有接收线程取出
+    std::atomic<uint32_t> _M_returned; // 每次归还批次时递增，接收线程在这个字上等待
+    std::atomic<bool> _M_starved;      // 接收线程是否正在等待空闲的批次
+
+    // 所使用的线程池，以及向它提交任务的函数；线程池是模板，这里擦除类型。
+    // 线程池暂停时推迟，只有终止时失败
+    void *_M_manager;
+    bool (*_M_post)(void *manager, Task &&task);
+    Latch _M_inFlight; // 已经提交但尚未处理完成的批次
+    std::thread _M_loop;
+
+    template <typename _Manager>
+    static bool postTo(void *manager, Task &&task)
+    {
+        return static_cast<_Manager *>(manager)->postOrDefer(std::move(task));
+    }
+
+    void run();
+
+    // 取出一个空闲的批次，全部在途时等待归还，停止时返回 nullptr
+    Batch *acquire();
+
+    static void process(void *arg);
+
+public:
+    /**
+     * 线程池暂停时批次推迟到恢复运行后处理，只有线程池已经终止时才在接收线程中处理。
+     * @template _Manager 提供 bool postOrDefer(Task &&) 的线程池，例如 ThreadManager
+     * @note 需要先于线程池和队列析构，并且不要在线程池暂停期间析构
+     */
+    template <typename _Manager>
+    ShmIngress(_Manager &manager, ShmQueue<_TyData> &queue, Handler handler)
+        : _M_queue(queue), _M_handler(std::move(handler)), _M_stop(false), _M_received(0),
+          _M_batches(new Batch[INGRESS_BATCHES]), _M_free(INGRESS_BATCHES), _M_returned(0),
+          _M_starved(false), _M_manager(&manager), _M_post(&ShmIngress::postTo<_Manager>)
+    {
+        for (size_t i = 0; i < INGRESS_BATCHES; i++)
+        {
+            _M_batches[i].ingress = this;
+            _M_free.tryPush(&_M_batches[i]);
+        }
+        _M_loop = std::thread(&ShmIngress::run, this);
+    }
+
+    ~ShmIngress()
+    {
+        _M_stop.store(true);
+        _M_queue.notifyAll();
+        _M_returned.fetch_add(1);
+        futexWake(&_M_returned);
+        if (_M_loop.joinable())
+            _M_loop.join();
+        _M_inFlight.wait();
+    }
+
+    ShmIngress(const ShmIngress &other) = delete;
+    ShmIngress &operator=(const ShmIngress &other) = delete;
+
+    // 已经从队列中取出的消息数量
+    size_t received() const { return _M_received.load(std::memory_order_relaxed); }
+};
+
+template <typename _TyData>
+constexpr size_t ShmIngress<_TyData>::INGRESS_BATCH;
+
+template <typename _TyData>
+constexpr size_t ShmIngress<_TyData>::INGRESS_BATCHES;
+
+template <typename _TyData>
+typename ShmIngress<_TyData>::Batch *ShmIngress<_TyData>::acquire()
+{
+    Batch *batch = nullptr;
+    while (!_M_free.tryPop(batch))
+    {
+        // 先声明等待再检查一次，归还者看到标志才唤醒，避免每个批次都进行系统调用
+        uint32_t returned = _M_returned.load();
+        _M_starved.store(true);
+        if (_M_free.tryPop(batch))
+            break;
+        if (_M_stop.load())
+            return nullptr;
+        futexWaitFor(&_M_returned, returned, std::chrono::milliseconds(100));
+    }
+    _M_starved.store(false, std::memory_order_relaxed);
+    return batch;
+}
+
+template <typename _TyData>
+void ShmIngress<_TyData>::run()
+{
+    Batch *batch = nullptr;
+    while (!_M_stop.load())
+    {
+        if (!batch && !(batch = acquire()))
+            break;
+        batch->nr = _M_queue.pop(batch->items, INGRESS_BATCH);
+        if (!batch->nr)
+        {
+            _M_queue.waitFor(std::chrono::milliseconds(100), [this]
+                             { return _M_stop.load(); });
+            continue;
+        }
+
+        _M_received.fetch_add(batch->nr, std::memory_order_relaxed);
+        _M_inFlight.add();
+        // 线程池暂停时批次被推迟到恢复运行；只有线程池已经终止时，
+        // 才直接在当前线程中处理，保证取出的消息不会丢失
+        if (!_M_post(_M_manager, Task(&ShmIngress::process, batch)))
+            process(batch);
+        batch = nullptr;
+    }
+}
+
+template <typename _TyData>
+void ShmIngress<_TyData>::process(void *arg)
+{
+    Batch *batch = static_cast<Batch *>(arg);
+    ShmIngress *ingress = batch->ingress;
+    for (size_t i = 0; i < batch->nr; i++)
+        ingress->_M_handler(batch->items[i]);
+    // 归还之后不再访问批次；done() 之后 ingress 可能已经析构
+    ingress->_M_free.tryPush(std::move(batch));
+    ingress->_M_returned.fetch_add(1);
+    if (ingress->_M_starved.load())
+        futexWake(&ingress->_M_returned, 1);
+    ingress->_M_inFlight.done();
+}
+
+#endif
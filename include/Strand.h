@@ -0,0 +1,83 @@
+/**
+ * @file Strand.h
+ * @author Xu.Cao
+ * @details
+ *  本文件定义了串行执行器 Strand。
+ * 提交到同一个 Strand 的任务按提交顺序执行，并且任意时刻最多只有一个在执行，
+ * 因此只被这些任务访问的状态不需要加锁：
+ * - 任务先放入 Strand 自己的多生产者单消费者队列，再递增待执行计数；
+ * - 计数从 0 变为 1 的提交者负责将 Strand 的「排空任务」提交到线程池；
+ * - 排空任务在一个工作线程上依次执行队列中的任务，每执行一批后重新提交自己，
+ *   让出工作线程。排队中的任务不占用任何工作线程；
+ * - 排空任务通过 postOrDefer 提交，线程池暂停或尚未启动时 Strand 保持待执行，
+ *   恢复运行后继续，只有线程池已经终止时才在当前线程中排空。
+ */
+#ifndef STRAND_H
+#define STRAND_H
+
+#include <atomic>
+#include <functional>
+#include "Task.h"
+#include "Future.h"
+#include "Queue.h"
+
+class Strand final
+{
+    static constexpr size_t BATCH_SIZE = 64; // 每次占用工作线程时最多执行的任务数量
+
+    MpscQueue<Task> _M_tasks;
+    std::atomic<size_t> _M_pending; // 已经提交但尚未执行完成的任务数量
+
+    // 所在的线程池，以及向它提交任务的函数；线程池是模板，这里擦除类型
+    void *_M_manager;
+    bool (*_M_post)(void *manager, Task &&task);
+
+    template <typename _Manager>
+    static bool postTo(void *manager, Task &&task)
+    {
+        return static_cast<_Manager *>(manager)->postOrDefer(std::move(task));
+    }
+
+    static void drain(void *arg);
+
+public:
+    static constexpr size_t STRAND_QUEUE_SIZE = 256;
+
+    /**
+     * @template _Manager 提供 bool postOrDefer(Task &&) 的线程池，例如 ThreadManager
+     * @param queueSize 队列长度，队列满时提交者等待
+     */
+    template <typename _Manager>
+    explicit Strand(_Manager *manager, size_t queueSize = STRAND_QUEUE_SIZE)
+        : _M_tasks(queueSize), _M_pending(0), _M_manager(manager),
+          _M_post(&Strand::postTo<_Manager>) {}
+
+    Strand(const Strand &other) = delete;
+    Strand &operator=(const Strand &other) = delete;
+
+    /**
+     * @brief 提交一个已经包装好的任务，不产生 future
+     *
+     * 线程池暂停或尚未启动时，任务在恢复运行后执行；线程池已经终止时，由当前线程直接执行。
+     * 队列满时会等待，因此不要在本 Strand 的任务中向本 Strand 提交大量任务。
+     */
+    bool post(Task &&task);
+
+    template <typename F, typename... ArgTp>
+    Future<typename std::result_of<F(ArgTp...)>::type> submit(F &&f, ArgTp &&...args)
+    {
+        using result_type = typename std::result_of<F(ArgTp...)>::type;
+
+        auto fn = std::bind(std::forward<F>(f), std::forward<ArgTp>(args)...);
+        PromiseTask<result_type, decltype(fn)> task_(std::move(fn));
+        Future<result_type> res = task_.getFuture();
+
+        post(Task(std::move(task_)));
+        return res;
+    }
+
+    // 尚未执行完成的任务数量
+    size_t size() const { return _M_pending.load(std::memory_order_relaxed); }
+};
+
+#endif
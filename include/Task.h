@@ -10,7 +10,10 @@
  * - 默认构造函数应该生成一个空任务，空任务的调用不会做任何事；
  * - 任务应该支持赋值和拷贝操作，但是一个任务只能由一个实例持有。
  *   如 Task a = b，则变量 b 失去对任务的所有权，而 a 获得。
+ *   这种「拷贝」只为兼容而保留，队列和线程池内部都通过移动转移任务。
  * 任务在最终将自动销毁，在析构函数中应该注意任务的释放。
+ * - 任务也可以由一个函数指针和一个参数指针直接构成，这种任务不申请堆内存，
+ *   适合任务图等需要反复提交相同任务、对分配敏感的场景，参数的生命周期由调用者保证。
  */
 class Task {
     /* 提供一个接口，可以调用执行，可以通过多态完成析构 */
@@ -21,9 +24,9 @@ class Task {
 
     template<typename PT>
     struct task_impl : task_base {
-        PT pt;  // 一个 packaged_task，可以用于执行等
+        PT pt;  // 一个 PromiseTask 或 packaged_task，可以用于执行等
 
-        /* packaged_task 只能通过右值引用来传递 */
+        /* PromiseTask 和 packaged_task 都只能通过右值引用来传递 */
         explicit task_impl(PT &&_pt) : pt(std::move(_pt)) {}
         ~task_impl() = default;
 
@@ -39,16 +42,26 @@ class Task {
     };
     
     std::unique_ptr<task_base> impl;
+    void (*func)(void *);   // 不申请内存的任务：直接调用 func(arg)
+    void *arg;
 public:
     /**
-     * 接收一个 std::packaged_task 类型的参数，将其包装依靠多态执行
-     * @tparam PT 具体任务类型，std::packaged_task<T>，只能移动拷贝
+     * 接收一个 PromiseTask 或 std::packaged_task 类型的参数，将其包装依靠多态执行
+     * @tparam PT 具体任务类型，需要提供 valid() 和 operator()，只能移动拷贝
      * @param _pt 实际的任务，只能移动传参
      */
     template<typename PT>
-    explicit Task(PT &&_pt) : impl(new task_impl<PT>(std::forward<PT>(_pt))) {}
+    explicit Task(PT &&_pt) : impl(new task_impl<PT>(std::forward<PT>(_pt))),
+                              func(nullptr), arg(nullptr) {}
 
-    Task(): impl(nullptr) {};
+    /**
+     * 由函数指针和参数构成的任务，不申请任何内存
+     * @param _func 任务执行时调用的函数
+     * @param _arg 传递给 _func 的参数，任务不持有其所有权
+     */
+    Task(void (*_func)(void *), void *_arg): impl(nullptr), func(_func), arg(_arg) {}
+
+    Task(): impl(nullptr), func(nullptr), arg(nullptr) {};
 
     ~Task() = default;
 
@@ -56,25 +69,36 @@ public:
         Task& otherTask = const_cast<Task&>(other);
         impl.reset();
         impl.swap(otherTask.impl);
+        func = otherTask.func;
+        arg = otherTask.arg;
+        otherTask.func = nullptr;
     }
-    Task(Task &&other): impl(std::move(other.impl)) {
+    Task(Task &&other) noexcept: impl(std::move(other.impl)), func(other.func), arg(other.arg) {
         other.impl.reset();
+        other.func = nullptr;
     }
 
     Task& operator=(const Task& other) noexcept {
         Task& otherTask = const_cast<Task&>(other);
         impl.reset();
         impl.swap(otherTask.impl);
+        func = otherTask.func;
+        arg = otherTask.arg;
+        otherTask.func = nullptr;
         return *this;
     }
-    Task& operator=(Task&& other) {
+    Task& operator=(Task&& other) noexcept {
         impl.reset();
         impl.swap(other.impl);
+        func = other.func;
+        arg = other.arg;
+        other.func = nullptr;
         return *this;
     }
 
     void operator()() {
         if (impl) impl->call();
+        else if (func) func(arg);
     }
 };
 
@@ -0,0 +1,118 @@
+/**
+ * @file TaskGraph.h
+ * @author Xu.Cao
+ * @details
+ *  本文件定义了基于 ThreadManager 的任务图（DAG）执行器。
+ * 用户先声明节点和边，然后在线程池上反复执行同一个任务图：
+ * - 每个节点带有一个原子的前驱计数，前驱全部完成后节点才会就绪；
+ * - 节点完成时，由完成它的工作线程直接接着执行第一个新就绪的后继，
+ *   其余后继提交到线程池，避免了在 future 上阻塞工作线程；
+ * - 节点和边在第一次执行前确定，之后的每次执行只重置计数，不申请任何内存；
+ * - 执行过程中线程池被暂停时，新就绪的节点推迟到恢复运行后执行，
+ *   只有线程池已经终止时才在完成前驱的线程中直接执行。
+ */
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <exception>
+#include "Task.h"
+#include "Latch.h"
+
+class TaskGraph final
+{
+public:
+    using NodeId = size_t;
+
+private:
+    struct Node
+    {
+        std::function<void()> func;
+        NodeId id;
+        std::vector<Node *> succ;     // 后继节点
+        size_t inDegree;              // 前驱数量，每次执行时用于重置计数
+        std::atomic<size_t> pending;  // 本次执行中尚未完成的前驱数量
+        TaskGraph *graph;
+
+        Node(std::function<void()> &&_func, NodeId _id, TaskGraph *_graph)
+            : func(std::move(_func)), id(_id), inDegree(0), pending(0), graph(_graph) {}
+    };
+
+    std::vector<std::unique_ptr<Node>> _M_nodes;
+    std::vector<Node *> _M_roots; // 没有前驱的节点，图改变后重新计算
+    bool _M_dirty;                // 图结构是否在上次检查后发生了改变
+    bool _M_acyclic;
+
+    // 当前执行所使用的线程池，以及向它提交任务的函数，
+    // 线程池是模板，这里擦除类型以便节点在库中调度
+    void *_M_manager;
+    bool (*_M_post)(void *manager, Task &&task); // 线程池暂停时推迟，只有终止时失败
+    Latch _M_remaining;        // 本次执行中尚未完成的节点数量
+    std::atomic_flag _M_failed;
+    std::exception_ptr _M_error;
+
+    static void execute(void *arg);
+
+    void dispatch(Node *node);
+
+    bool prepare();
+
+    bool launch(void *manager, bool (*start)(void *, Task &&), bool (*post)(void *, Task &&));
+
+    // 提交第一个根节点，线程池不在运行状态时失败
+    template <typename _Manager>
+    static bool startTo(void *manager, Task &&task)
+    {
+        return static_cast<_Manager *>(manager)->post(std::move(task));
+    }
+
+    template <typename _Manager>
+    static bool postTo(void *manager, Task &&task)
+    {
+        return static_cast<_Manager *>(manager)->postOrDefer(std::move(task));
+    }
+
+public:
+    TaskGraph() : _M_dirty(false), _M_acyclic(true), _M_manager(nullptr), _M_post(nullptr)
+    {
+        _M_failed.clear();
+    }
+
+    TaskGraph(const TaskGraph &other) = delete;
+    TaskGraph &operator=(const TaskGraph &other) = delete;
+
+    /**
+     * @brief 添加一个节点
+     * @return NodeId 节点编号，用于添加边
+     */
+    NodeId addNode(std::function<void()> func);
+
+    /**
+     * @brief 添加一条边，节点 to 只有在节点 from 完成后才会执行
+     */
+    void addEdge(NodeId from, NodeId to);
+
+    /**
+     * @brief 在线程池上执行一次任务图，并阻塞等待全部节点完成
+     *
+     * 同一个任务图同一时刻只能有一次执行；不能在本线程池的工作线程中调用，
+     * 否则等待过程会占用一个工作线程。
+     * 如果某个节点抛出异常，其余节点仍然执行完成，之后重新抛出第一个异常。
+     *
+     * @template _Manager 提供 bool post(Task &&) 和 bool postOrDefer(Task &&) 的线程池，
+     *  例如 ThreadManager
+     * @return bool 图中存在环，或者开始时线程池不在运行状态时返回 false
+     */
+    template <typename _Manager>
+    bool run(_Manager &manager)
+    {
+        return launch(&manager, &TaskGraph::startTo<_Manager>, &TaskGraph::postTo<_Manager>);
+    }
+
+    size_t size() const { return _M_nodes.size(); }
+};
+
+#endif
@@ -3,7 +3,12 @@
  * @author Xu.Cao
  * @details
  *  本代码主要用于线程管理，由于线程管理部分耦合度较高，因此统一放置在本文件中。
- * 本模块主要包括：Thread、ThreadManager 两大类，具体细节请参见类注释。
+ * 本模块主要包括：BasicThread、BasicThreadManager 两大类模板，具体细节请参见类注释。
+ *
+ *  队列类型、等待策略、统计策略和锁都是编译期的模板参数（参见 Policy.h），
+ * 工作线程直接通过具体的队列类型取任务，不再经过虚函数分发。
+ * Thread 和 ThreadManager 是默认策略下的类型别名，行为与之前保持一致，
+ * 它们在库中显式实例化。
  */
 #ifndef THREAD_H
 #define THREAD_H
@@ -15,19 +20,42 @@
 #include <condition_variable>
 #include <vector>
 #include <functional>
+#include <chrono>
 #include "Task.h"
+#include "Future.h"
 #include "Lock.h"
+#include "Latch.h"
 #include "Queue.h"
+#include "Policy.h"
+#include "Gate.h"
+#include "Strand.h"
+#include "WorkerLocal.h"
+#include "NativeThread.h"
+#include "Phases.h"
+#include "Trace.h"
 
 #ifndef NDEBUG
 #include <stdio.h>
 #endif
 
 /* 此处是各个类的声明，主要为了后续交叉引用做准备 */
-class Thread;
-class ThreadManager;
+template <typename _Queue, typename _Wait, typename _Stats>
+class BasicThread;
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+class BasicThreadManager;
 
-class Thread final
+/**
+ * @template _Queue 共享任务队列的具体类型
+ * @template _Wait 等待策略
+ * @template _Stats 统计策略
+ * @class BasicThread
+ * @brief 工作线程，从收件箱和共享队列中获取任务执行
+ *
+ * 独立使用时，线程使用自己的等待和统计策略对象；由线程池创建时，
+ * 使用线程池的策略对象，从而可以被线程池统一唤醒和统计。
+ */
+template <typename _Queue, typename _Wait = YieldWait, typename _Stats = NoStats>
+class BasicThread final
 {
     using ThreadStatus = int;
     static constexpr int THREAD_CREATED = 0x1;
@@ -35,42 +63,254 @@ class Thread final
     static constexpr int THREAD_PAUSE = 0x4;
     static constexpr int THREAD_TERMINATED = 0x8;
 
-    Queue<Task> *_M_taskQue;
-    std::thread *_M_thread;
+    _Queue *_M_taskQue;
+    MpscQueue<Task> *_M_inbox; // 只属于本线程的收件箱，优先于共享队列执行
+    Latch *_M_latch;           // 每完成一个任务，都需要通知在途任务计数
+    const void *_M_owner;      // 所属的线程池，独立使用时为空
+    PauseGate *_M_gate;        // 所属线程池的暂停闸门，独立使用时为空
+    size_t _M_index;           // 在所属线程池中的编号
+    WorkerStorage _M_storage;  // 线程私有的对象和 Arena
+    _Wait _M_ownWait;
+    _Stats _M_ownStats;
+    _Wait *_M_wait;
+    _Stats *_M_stats;
+    // 所属线程池要求回收内存时递增，与 _M_trimmed 不同时线程在空闲时回收
+    const std::atomic<uint32_t> *_M_trimEpoch;
+    uint32_t _M_trimmed;
+    ThreadAttr _M_attr;
+    NativeThread _M_thread;
     std::atomic<ThreadStatus> _M_status;
 
+    // 直接交付：空闲时宣告自己，提交者把任务放入单任务邮箱并只唤醒本线程
+    std::atomic<size_t> *_M_idleNr; // 所属线程池中宣告空闲的线程数量，为空时不接受交付
+    std::atomic<uint32_t> _M_handoff; // 邮箱状态，参见 Policy.h 中的 HANDOFF_*
+    Task _M_mailbox;
+
     std::mutex _M_mutex;
     std::condition_variable _M_cond;
 
+    static thread_local BasicThread *_S_current; // 当前线程对应的 Thread 实体
+
+    // 改变状态后唤醒线程，加锁保证线程要么还没检查状态，要么已经进入等待
+    void wake()
+    {
+        std::lock_guard<std::mutex> lock(_M_mutex);
+        _M_cond.notify_one();
+    }
+
+    bool hasWork() const
+    {
+        return !_M_taskQue->empty() || (_M_inbox && !_M_inbox->empty()) ||
+               _M_status.load(std::memory_order_relaxed) != THREAD_RUNNING ||
+               (_M_idleNr && !idle(_M_handoff.load()));
+    }
+
+    static bool idle(uint32_t state) { return state == HANDOFF_IDLE || state == HANDOFF_PARKED; }
+
+    // 宣告空闲，之后提交者可以直接交付任务；先计数再改状态，提交者看到状态时一定也能看到计数
+    void arm()
+    {
+        if (_M_handoff.load(std::memory_order_relaxed) != HANDOFF_BUSY)
+            return;
+        _M_idleNr->fetch_add(1);
+        _M_handoff.store(HANDOFF_IDLE);
+    }
+
+    // 撤销空闲宣告，已经有任务交付过来时返回 false，任务需要由 takeHandoff 取走
+    bool disarm()
+    {
+        if (!_M_idleNr)
+            return true;
+        uint32_t state = _M_handoff.load();
+        while (idle(state))
+        {
+            if (_M_handoff.compare_exchange_weak(state, HANDOFF_BUSY))
+            {
+                _M_idleNr->fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return state == HANDOFF_BUSY;
+    }
+
+    // 取走交付的任务，提交者正在写入时短暂等待
+    bool takeHandoff(Task &task)
+    {
+        if (!_M_idleNr)
+            return false;
+        uint32_t state;
+        while ((state = _M_handoff.load(std::memory_order_acquire)) == HANDOFF_CLAIMED)
+            cpuRelax();
+        if (state != HANDOFF_READY)
+            return false;
+        task = std::move(_M_mailbox);
+        _M_handoff.store(HANDOFF_BUSY, std::memory_order_relaxed);
+        return true;
+    }
+
+    void execute(Task &task)
+    {
+        task();
+        // 任务中使用的临时内存在任务结束后整体回收
+        _M_storage.arena().reset();
+        _M_stats->onExecute();
+        if (_M_latch)
+            _M_latch->done();
+    }
+
+    bool trimPending() const
+    {
+        return _M_trimEpoch && _M_trimEpoch->load(std::memory_order_relaxed) != _M_trimmed;
+    }
+
+    // 归还 Arena、共享状态缓存和栈中空闲的内存，只能由本线程在两个任务之间调用
+    void trim()
+    {
+        _M_trimmed = _M_trimEpoch->load(std::memory_order_relaxed);
+        _M_storage.arena().release();
+        StateCache::trimAll();
+        trimThreadStack();
+    }
+
+    static void entry(void *arg) { static_cast<BasicThread *>(arg)->run(); }
+
 public:
     void run();
 
-    ~Thread();
+    ~BasicThread();
 
-    Thread() : _M_taskQue(nullptr), _M_status(THREAD_CREATED) {}
+    BasicThread() : _M_taskQue(nullptr), _M_inbox(nullptr), _M_latch(nullptr),
+                    _M_owner(nullptr), _M_gate(nullptr), _M_index(0),
+                    _M_wait(&_M_ownWait), _M_stats(&_M_ownStats),
+                    _M_trimEpoch(nullptr), _M_trimmed(0), _M_status(THREAD_CREATED),
+                    _M_idleNr(nullptr), _M_handoff(HANDOFF_BUSY) {}
 
-    Thread(Queue<Task> *taskQueue) : _M_taskQue(taskQueue),
-                                     _M_status(THREAD_CREATED)
+    BasicThread(_Queue *taskQueue, Latch *latch = nullptr)
+        : _M_taskQue(taskQueue), _M_inbox(nullptr), _M_latch(latch),
+          _M_owner(nullptr), _M_gate(nullptr), _M_index(0),
+          _M_wait(&_M_ownWait), _M_stats(&_M_ownStats),
+          _M_trimEpoch(nullptr), _M_trimmed(0), _M_status(THREAD_CREATED),
+          _M_idleNr(nullptr), _M_handoff(HANDOFF_BUSY)
     {
-        _M_thread = new std::thread(&Thread::run, this);
+        _M_thread.start(&BasicThread::entry, this, _M_attr);
     }
 
-    Thread(const Thread &other) = delete;
-    Thread(Thread &&other) noexcept = delete;
-    Thread &operator=(const Thread &other) = delete;
-    Thread &operator=(Thread &&other) noexcept = delete;
+    BasicThread(const BasicThread &other) = delete;
+    BasicThread(BasicThread &&other) noexcept = delete;
+    BasicThread &operator=(const BasicThread &other) = delete;
+    BasicThread &operator=(BasicThread &&other) noexcept = delete;
 
-    void setQue(Queue<Task> *quePtr)
+    void setQue(_Queue *quePtr, Latch *latch = nullptr)
     {
         if (!_M_taskQue &&
             _M_status.load(std::memory_order_consume) & THREAD_CREATED)
         {
             _M_taskQue = quePtr;
+            _M_latch = latch;
         }
 
-        _M_thread = new std::thread(&Thread::run, this);
+        _M_thread.start(&BasicThread::entry, this, _M_attr);
+    }
+
+    void setOwner(const void *owner) { _M_owner = owner; }
+
+    const void *getOwner() const { return _M_owner; }
+
+    // 每个任务开始前检查闸门，闸门关闭时睡眠；必须在 setQue 之前设置
+    void setGate(PauseGate *gate) { _M_gate = gate; }
+
+    // 线程的栈属性，必须在 setQue 之前设置
+    void setAttr(const ThreadAttr &attr) { _M_attr = attr; }
+
+    // epoch 改变后，线程在空闲时归还内存；必须在 setQue 之前设置
+    void setTrim(const std::atomic<uint32_t> *epoch)
+    {
+        _M_trimEpoch = epoch;
+        _M_trimmed = epoch->load(std::memory_order_relaxed);
     }
 
+    // 唤醒暂停或者尚未启动的线程，使其检查是否需要回收内存
+    void requestTrim()
+    {
+        wake();
+        kick();
+    }
+
+    // 开启直接交付，idleNr 由同一个线程池的线程共享；必须在 setQue 之前设置
+    void setHandoff(std::atomic<size_t> *idleNr) { _M_idleNr = idleNr; }
+
+    /**
+     * @brief 本线程空闲时，把任务放入邮箱并只唤醒本线程
+     *
+     * 成功时任务被移走，并计入在途任务；线程忙碌或者没有开启直接交付时返回 false，
+     * 任务保持不变。
+     * @param parked 是否交付给已经睡眠的线程，睡眠的线程需要一次系统调用才能唤醒
+     */
+    bool offer(Task &task, bool parked = true)
+    {
+        uint32_t state = _M_handoff.load(std::memory_order_relaxed);
+        while (_M_idleNr && (state == HANDOFF_IDLE || (parked && state == HANDOFF_PARKED)))
+        {
+            if (_M_handoff.compare_exchange_weak(state, HANDOFF_CLAIMED))
+            {
+                _M_idleNr->fetch_sub(1, std::memory_order_relaxed);
+                // 计数必须先于交付，否则任务可能在计数之前就执行完成
+                if (_M_latch)
+                    _M_latch->add();
+                _M_mailbox = std::move(task);
+                _M_handoff.store(HANDOFF_READY, std::memory_order_release);
+                if (state == HANDOFF_PARKED)
+                    futexWake(&_M_handoff, 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 撤销本线程的空闲宣告并唤醒它，使其重新检查队列和状态
+     * @return bool 本线程原本处于空闲宣告状态时返回 true
+     */
+    bool kick()
+    {
+        uint32_t state = _M_handoff.load(std::memory_order_relaxed);
+        while (_M_idleNr && idle(state))
+        {
+            if (_M_handoff.compare_exchange_weak(state, HANDOFF_BUSY))
+            {
+                _M_idleNr->fetch_sub(1, std::memory_order_relaxed);
+                if (state == HANDOFF_PARKED)
+                    futexWake(&_M_handoff, 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 邮箱中是否有尚未取走的任务
+    bool handoffPending() const { return _M_handoff.load(std::memory_order_relaxed) >= HANDOFF_CLAIMED; }
+
+    void setIndex(size_t index) { _M_index = index; }
+
+    size_t index() const { return _M_index; }
+
+    WorkerStorage &storage() { return _M_storage; }
+
+    // 收件箱只有本线程消费，必须在 setQue 之前设置
+    void setInbox(MpscQueue<Task> *inbox) { _M_inbox = inbox; }
+
+    MpscQueue<Task> *getInbox() const { return _M_inbox; }
+
+    // 使用线程池的策略对象，必须在 setQue 之前设置
+    void setPolicy(_Wait *wait, _Stats *stats)
+    {
+        _M_wait = wait;
+        _M_stats = stats;
+    }
+
+    // 当前线程对应的 Thread 实体，不是由 Thread 创建的线程返回 nullptr
+    static BasicThread *current() { return _S_current; }
+
     void start();
 
     void pause();
@@ -82,8 +322,55 @@ public:
     ThreadStatus getStatus() const { return _M_status.load(std::memory_order::memory_order_consume); }
 };
 
-class ThreadManager
+/**
+ * 限时关闭线程池的结果，记录截止时刻仍未完成的任务。
+ * - queued：仍在队列中、被丢弃的任务数量；
+ * - running：已经被取出、正在执行的任务数量，关闭过程会等待它们执行结束。
+ */
+struct ShutdownReport
+{
+    bool drained;
+    size_t queued;
+    size_t running;
+};
+
+/**
+ * 线程池的可选配置。
+ * - stackSize/guardSize：工作线程的栈大小和保护页大小，参见 ThreadAttr；
+ * - idleTrim：线程池连续空闲这么久之后，归还共享队列和收件箱的槽位、每个线程的 Arena、
+ *   缓存的共享状态和栈中空闲的物理内存，下次使用时再按需分配；为 0 时不回收；
+ *   回收由管理线程发起，需要锁策略排除并发的提交，使用 NullLock 时被忽略；
+ * - handoff：有空闲的工作线程时，提交的任务直接放入该线程的邮箱并只唤醒它，
+ *   不经过共享队列，默认开启。
+ */
+struct PoolOptions
+{
+    size_t stackSize;
+    size_t guardSize;
+    std::chrono::milliseconds idleTrim;
+    bool handoff;
+
+    PoolOptions() : stackSize(0), guardSize(STACK_GUARD_DEFAULT), idleTrim(0), handoff(true) {}
+};
+
+/**
+ * @template _Queue 共享任务队列的具体类型，需要提供 tryPush/tryPop/size/capacity/empty/full，
+ *  并且允许多个线程同时出队，SpscQueue、MpscQueue 只有一个消费者，不能使用
+ * @template _Wait 等待策略，参见 YieldWait、SpinWait、ParkWait
+ * @template _Stats 统计策略，参见 NoStats、CountingStats
+ * @template _Lock 锁策略，需要提供 lock()/unlock()
+ * @class BasicThreadManager
+ * @brief 线程池
+ */
+template <typename _Queue = LockFreeQueue<Task>, typename _Wait = YieldWait,
+          typename _Stats = NoStats, typename _Lock = spinLock>
+class BasicThreadManager
 {
+    static_assert(!SingleConsumer<_Queue>::value,
+                  "every worker pops the shared queue, _Queue must allow multiple consumers");
+
+    using _Thread = BasicThread<_Queue, _Wait, _Stats>;
+
     // 状态应该使用**位**存储，确保可以一次性判断是否处于某个状态集合。
     // 例如，是否正在运行或者已经停止，可以使用：
     // _M_status & (POOL_PAUSE | POOL_TERMINATED) 来测试
@@ -94,36 +381,215 @@ class ThreadManager
     static constexpr int POOL_TERMINATED = 0x8;
 
     static const size_t coreNr;
+    static constexpr size_t COMPENSATOR_MAX = 64;
+    static constexpr size_t INBOX_SIZE = 128;
+    static constexpr size_t KEYED_STRAND_NR = 64; // submitKeyed 使用的串行执行器数量
+
+public:
+    static constexpr size_t WORKER_NONE = SIZE_MAX; // 不是本线程池工作线程时的编号
+
+private:
+
+    // 线程池至少需要两个线程
+    static size_t fixedSize(size_t poolSize) { return poolSize > 1 ? poolSize : 2; }
+
+    // NullLock 不能阻止管理线程在提交线程写入时回收队列，因此不支持 idleTrim
+    static PoolOptions fixedOptions(const PoolOptions &options)
+    {
+        PoolOptions fixed = options;
+        if (std::is_same<_Lock, NullLock>::value && fixed.idleTrim.count() > 0)
+        {
+#ifndef NDEBUG
+            printf("\033[33m[WARNING] ThreadPool: idleTrim is ignored with NullLock!\033[0m\n");
+#endif
+            fixed.idleTrim = std::chrono::milliseconds(0);
+        }
+        return fixed;
+    }
+
+    // 策略对象需要先于线程构造、晚于线程析构
+    _Wait _M_wait;
+    _Stats _M_stats;
 
-    std::vector<Thread> _M_threads;
-    LockFreeQueue<Task> _M_tasks;
+    std::vector<_Thread> _M_threads;
+    // 每个工作线程的收件箱，只有对应的线程消费，因此使用多生产者单消费者队列
+    std::vector<std::unique_ptr<MpscQueue<Task>>> _M_inboxes;
+    // 补偿线程：当工作线程声明即将阻塞时激活，阻塞结束后暂停以便复用
+    std::vector<std::unique_ptr<_Thread>> _M_compensators;
+    size_t _M_compensatorNr;          // 正在运行的补偿线程数量，受 _M_compensatorLock 保护
+    std::atomic<size_t> _M_blockedNr; // 正处于阻塞区间的工作线程数量
+    _Queue _M_tasks;
+    std::vector<Task> _M_deferred; // 暂停或尚未启动时推迟提交的任务，受 _M_threadLock 保护
     std::atomic<PoolStatus> _M_status;
     size_t _M_poolSize;
     std::atomic<size_t> _M_activeNr;
+    Latch _M_inFlight; // 已提交但尚未执行完成的任务（包括队列中和正在执行的）
+    PauseGate _M_gate; // 线程池暂停时关闭，工作线程在两个任务之间检查
+    PoolOptions _M_options;
+    std::atomic<uint32_t> _M_trimEpoch; // 每次回收内存时递增，工作线程在空闲时响应
+    std::atomic<TraceRecorder *> _M_trace; // 采集负载时非空，提交的任务被包装为带计时的任务
+    std::atomic<size_t> _M_idleNr;        // 宣告空闲、可以直接交付任务的工作线程数量
+    std::atomic<size_t> _M_handoffNext;   // 下一次交付从哪个线程开始查找，使交付分散到各个线程
     std::thread _M_manager;
 
+    // 由本线程池创建的串行执行器，生命周期与线程池一致
+    std::vector<std::unique_ptr<Strand>> _M_strands;
+    // submitKeyed 按键的哈希值选择的串行执行器，第一次使用时创建
+    std::atomic<Strand *> _M_keyed[KEYED_STRAND_NR];
+    spinLock _M_strandLock;
+
     std::mutex _M_mutex;
-    // 使用自旋锁将线程池状态和线程实体绑定，
+    // 使用锁将线程池状态和线程实体绑定，
     // 避免出现状态和线程实际工作状态不一致。
     // 改变状态和线程操作同时进行
-    spinLock _M_threadLock;
+    _Lock _M_threadLock;
+    // 补偿线程单独加锁：提交任务时可能持有 _M_threadLock 等待队列空位，
+    // 而腾出空位的工作线程此时可能正要进入阻塞区间
+    spinLock _M_compensatorLock;
     std::condition_variable _M_cond;
 
+    // 队列的压力，即已使用的比例
+    float getStress() const
+    {
+        return (float)(_M_tasks.size() + 1) / _M_tasks.capacity();
+    }
+
+    // 采集负载时包装任务，否则原样返回
+    Task traced(Task &&task)
+    {
+        TraceRecorder *trace = _M_trace.load(std::memory_order_acquire);
+        return trace ? trace->wrap(std::move(task)) : std::move(task);
+    }
+
+    // 将任务放入指定队列，队列满时等待；调用者需要持有 _M_threadLock
+    template <typename _TyQue>
+    void enqueue(_TyQue &que, Task &&task)
+    {
+        // 计数必须先于入队，否则任务可能在计数之前就执行完成
+        _M_inFlight.add();
+        while (!que.tryPush(std::move(task)))
+        {
+            std::this_thread::yield();
+        }
+        _M_stats.onSubmit();
+    }
+
+    // 把任务直接交给一个宣告空闲的工作线程，没有空闲的线程时返回 false，任务保持不变
+    bool handoff(Task &task)
+    {
+        if (!_M_idleNr.load())
+            return false;
+        size_t activeNr = _M_activeNr.load(std::memory_order_relaxed);
+        size_t first = _M_handoffNext.fetch_add(1, std::memory_order_relaxed);
+        // 先找还在自旋的线程，它们不需要系统调用就能取走任务，找不到再唤醒睡眠的线程
+        for (int parked = 0; parked < 2; parked++)
+        {
+            for (size_t i = 0; i < activeNr; i++)
+            {
+                if (_M_threads[(first + i) % activeNr].offer(task, parked))
+                {
+                    _M_stats.onSubmit();
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // 任务进入共享队列后，唤醒一个宣告空闲的线程；
+    // 与工作线程先宣告再检查队列相对应，保证不会有线程在邮箱上错过这个任务
+    void kickIdle()
+    {
+        if (!_M_options.handoff)
+            return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_M_idleNr.load(std::memory_order_relaxed))
+            return;
+        size_t activeNr = _M_activeNr.load(std::memory_order_relaxed);
+        size_t first = _M_handoffNext.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < activeNr; i++)
+        {
+            if (_M_threads[(first + i) % activeNr].kick())
+                return;
+        }
+    }
+
+    /**
+     * @brief 提交到共享队列的任务优先直接交付，否则入队；调用者需要持有 _M_threadLock
+     * @return bool 任务被直接交付时返回 true，此时不需要再通过等待策略唤醒线程
+     */
+    bool dispatch(Task &&task)
+    {
+        task = traced(std::move(task));
+        if (handoff(task))
+            return true;
+        enqueue(_M_tasks, std::move(task));
+        kickIdle();
+        return false;
+    }
+
+    // 提交推迟的任务，调用者需要持有 _M_threadLock 并且线程池正在运行
+    bool flushDeferred()
+    {
+        if (_M_deferred.empty())
+            return false;
+        for (auto &task : _M_deferred)
+        {
+            dispatch(std::move(task));
+        }
+        _M_deferred.clear();
+        return true;
+    }
+
+    Strand *keyedStrand(size_t hash);
+
+    // 编号对应的工作线程的私有存储，编号无效时返回 nullptr
+    WorkerStorage *storageOf(size_t index)
+    {
+        if (index < _M_poolSize)
+            return &_M_threads[index].storage();
+        index -= _M_poolSize;
+        _M_compensatorLock.lock();
+        WorkerStorage *storage = index < _M_compensators.size() ? &_M_compensators[index]->storage() : nullptr;
+        _M_compensatorLock.unlock();
+        return storage;
+    }
+
+    // 线程池空闲超过 idleTrim 后回收一次内存，之后直到再次有任务才重新计时
+    void trimIfIdle(std::chrono::steady_clock::time_point &idleSince, bool &trimmed);
+
 public:
-    ThreadManager(size_t poolSize = 10, size_t queueSize = 1000)
-        : _M_threads(poolSize), _M_tasks(queueSize),
-          _M_status(POOL_CREATED), _M_poolSize(poolSize),
-          _M_activeNr(0)
+    BasicThreadManager(size_t poolSize = 10, size_t queueSize = 1000)
+        : BasicThreadManager(poolSize, queueSize, PoolOptions()) {}
+
+    BasicThreadManager(size_t poolSize, size_t queueSize, const PoolOptions &options)
+        : _M_threads(fixedSize(poolSize)), _M_inboxes(fixedSize(poolSize)),
+          _M_compensatorNr(0), _M_blockedNr(0),
+          _M_tasks(queueSize), _M_status(POOL_CREATED), _M_poolSize(fixedSize(poolSize)),
+          _M_activeNr(0), _M_options(fixedOptions(options)), _M_trimEpoch(0), _M_trace(nullptr),
+          _M_idleNr(0), _M_handoffNext(0)
     {
-        if (poolSize <= 1)
+        for (size_t i = 0; i < _M_poolSize; i++)
         {
-            _M_poolSize = poolSize = 2;
+            _M_inboxes[i].reset(new MpscQueue<Task>(INBOX_SIZE));
+            _M_threads[i].setInbox(_M_inboxes[i].get());
+            _M_threads[i].setOwner(this);
+            _M_threads[i].setIndex(i);
+            _M_threads[i].setGate(&_M_gate);
+            _M_threads[i].setAttr(ThreadAttr(options.stackSize, options.guardSize));
+            _M_threads[i].setTrim(&_M_trimEpoch);
+            if (options.handoff)
+                _M_threads[i].setHandoff(&_M_idleNr);
+            _M_threads[i].setPolicy(&_M_wait, &_M_stats);
+            _M_threads[i].setQue(&_M_tasks, &_M_inFlight);
         }
-        for (int i = 0; i < poolSize; i++)
+        for (size_t i = 0; i < KEYED_STRAND_NR; i++)
         {
-            _M_threads[i].setQue(&_M_tasks);
+            _M_keyed[i].store(nullptr, std::memory_order_relaxed);
         }
-        _M_manager = std::thread(&ThreadManager::manage, this);
+        // 补偿线程的编号紧接在工作线程之后，预留空间保证按编号访问时不会因扩容而失效
+        _M_compensators.reserve(COMPENSATOR_MAX);
+        _M_manager = std::thread(&BasicThreadManager::manage, this);
 
 #ifndef NDEBUG
         printf("[INFO] ThreadPool: Initialized with %lu threads and %lu slots in the queue at most!\n",
@@ -131,27 +597,168 @@ public:
 #endif
     }
 
-    ~ThreadManager();
+    ~BasicThreadManager();
 
     void manage();
 
+private:
+    // 共享队列和所有收件箱中尚未取出的任务数量
+    size_t queuedNr() const;
+
+    // 唤醒收件箱中还有任务的线程，关闭前调用
+    void drainInboxes();
+
+    // 尚未启动的线程池中有推迟的任务时启动它，关闭前调用
+    void startIfDeferred()
+    {
+        _M_threadLock.lock();
+        bool deferred = (_M_status.load(std::memory_order_consume) & POOL_CREATED) && !_M_deferred.empty();
+        _M_threadLock.unlock();
+        if (deferred)
+            start();
+    }
+
+    // 当前线程是本线程池的工作线程时，登记阻塞并按需激活补偿线程
+    bool beginBlocking();
+
+    void endBlocking();
+
+    struct BlockingGuard
+    {
+        BasicThreadManager *manager;
+        bool counted;
+
+        explicit BlockingGuard(BasicThreadManager *_manager)
+            : manager(_manager), counted(_manager->beginBlocking()) {}
+        ~BlockingGuard()
+        {
+            if (counted)
+                manager->endBlocking();
+        }
+    };
+
+public:
+    /**
+     * @brief 在阻塞区间中执行 scope
+     *
+     * 任务即将进行阻塞的文件 I/O 或者等待锁时，将阻塞的部分包装在 scope 中。
+     * 线程池会临时激活一个补偿线程，使得未阻塞的工作线程数量保持不变；
+     * scope 返回（或抛出异常）后，补偿线程在完成手头的任务后暂停。
+     * 在非本线程池工作线程中调用时，直接执行 scope。
+     *
+     * @return scope 的返回值
+     */
+    template <typename F>
+    auto blocking(F &&scope) -> decltype(scope())
+    {
+        BlockingGuard guard(this);
+        return scope();
+    }
+
+    size_t blockedNr() const { return _M_blockedNr.load(std::memory_order_relaxed); }
+
+    // 当前处于活动状态的工作线程数量
+    size_t workerNr() const { return _M_activeNr.load(std::memory_order_relaxed); }
+
+    // 可能出现的工作线程编号上限（包括补偿线程），用于按编号遍历
+    size_t workerSlotNr() const { return _M_poolSize + COMPENSATOR_MAX; }
+
+    // 当前线程在本线程池中的编号，不是本线程池的工作线程时返回 WORKER_NONE
+    size_t workerIndex() const
+    {
+        _Thread *self = _Thread::current();
+        return self && self->getOwner() == this ? self->index() : WORKER_NONE;
+    }
+
+    /**
+     * @brief 当前工作线程私有的 _Ty 对象，第一次访问时默认构造
+     *
+     * 任务可以先通过 workerIndex() 取得编号，再按编号访问，避免重复查找线程局部变量。
+     * 在非本线程池的线程中调用时，返回调用线程自己的对象。
+     */
+    template <typename _Ty>
+    _Ty &workerLocal()
+    {
+        size_t index = workerIndex();
+        if (index == WORKER_NONE)
+        {
+            static thread_local _Ty local;
+            return local;
+        }
+        return workerLocal<_Ty>(index);
+    }
+
+    /**
+     * @brief 编号为 index 的工作线程私有的 _Ty 对象
+     *
+     * 对象只能由该工作线程自己构造；其他线程应该在线程池空闲时通过 findWorkerLocal 读取。
+     */
+    template <typename _Ty>
+    _Ty &workerLocal(size_t index) { return storageOf(index)->template get<_Ty>(); }
+
+    // 编号为 index 的工作线程已经构造的 _Ty 对象，不存在时返回 nullptr
+    template <typename _Ty>
+    _Ty *findWorkerLocal(size_t index)
+    {
+        WorkerStorage *storage = storageOf(index);
+        return storage ? storage->template find<_Ty>() : nullptr;
+    }
+
+    /**
+     * @brief 当前工作线程的 Arena，每个任务执行结束后自动重置，也可以随时调用 reset
+     *
+     * 在非本线程池的线程中调用时，返回调用线程自己的 Arena，它不会被自动重置。
+     */
+    Arena &workerArena()
+    {
+        size_t index = workerIndex();
+        if (index == WORKER_NONE)
+        {
+            static thread_local Arena local;
+            return local;
+        }
+        return storageOf(index)->arena();
+    }
+
+    // 统计策略对象，例如 CountingStats 可以读取各项计数
+    const _Stats &stats() const { return _M_stats; }
+
+    /**
+     * @brief 开始或停止（传入 nullptr）采集提交到本线程池的任务，参见 Trace.h
+     *
+     * 只记录设置之后提交的任务；记录器需要在这些任务全部完成之后才能保存或销毁，
+     * 例如先 setTrace(nullptr)，再等待已提交任务的 future 或者关闭线程池。
+     */
+    void setTrace(TraceRecorder *trace) { _M_trace.store(trace, std::memory_order_release); }
+
     void start();
 
     void pause();
 
     void resume();
 
-    // 关闭，但是完成剩余任务
+    // 关闭，但是完成剩余任务；阻塞等待队列排空并且所有正在执行的任务结束
     void shutdown();
 
+    // 限时关闭，超时后丢弃队列中剩余的任务，并返回截止时刻剩余的任务情况
+    ShutdownReport shutdownFor(std::chrono::nanoseconds timeout);
+
     // 关闭，并且抛弃剩余任务
     void forceShutdown();
 
+    /**
+     * @brief 立即回收空闲内存：队列为空时归还共享队列和收件箱的槽位，并通知每个工作线程
+     *  在空闲时归还自己的 Arena、缓存的共享状态和栈中空闲的页面
+     * @note 使用 NullLock 时只能在唯一的提交线程中调用
+     * @return size_t 共享队列和收件箱归还的字节数
+     */
+    size_t trim();
+
     template <typename F, typename... ArgTp>
-    std::future<typename std::result_of<F(ArgTp)...>::type> trySubmit(F &&f, ArgTp &&...args)
+    Future<typename std::result_of<F(ArgTp...)>::type> trySubmit(F &&f, ArgTp &&...args)
     {
-        using result_type = typename std::result_of<F(ArgTp)...>::type;
-        std::future<result_type> dummy;
+        using result_type = typename std::result_of<F(ArgTp...)>::type;
+        Future<result_type> dummy;
         if (_M_tasks.full())
         {
 #ifndef NDEBUG
@@ -160,48 +767,843 @@ public:
             return dummy;
         }
 
-        std::packaged_task<result_type()> task_(std::bind(std::forward<F>(f),
-                                                          std::forward<ArgTp>(args)...));
-        std::future<result_type> res = task_.get_future();
+        auto fn = std::bind(std::forward<F>(f), std::forward<ArgTp>(args)...);
+        PromiseTask<result_type, decltype(fn)> task_(std::move(fn));
+        Future<result_type> res = task_.getFuture();
 
-        Task task(std::move(task_));
+        Task task = traced(Task(std::move(task_)));
 
-        if (_M_status.load(std::memory_order_consume) & (~POOL_RUNNING) ||
-            !_M_tasks.push(&task, 1))
+        _M_threadLock.lock();
+        if (!(_M_status.load(std::memory_order_consume) & (~POOL_RUNNING)) && handoff(task))
         {
+            _M_threadLock.unlock();
+            return res;
+        }
+
+        // 计数必须先于入队，否则任务可能在计数之前就执行完成；
+        // 加锁保证回收队列内存时没有并发的写入
+        _M_inFlight.add();
+        bool pushed = !(_M_status.load(std::memory_order_consume) & (~POOL_RUNNING)) &&
+                      _M_tasks.tryPush(std::move(task));
+        if (pushed)
+            kickIdle();
+        _M_threadLock.unlock();
+        if (!pushed)
+        {
+            _M_inFlight.done();
 #ifndef NDEBUG
             printf("\033[33m[WARNING] ThreadPool: Task appended failed, 'cause pool is not running!\033[0m\n");
 #endif
             return dummy;
         }
+        _M_stats.onSubmit();
+        _M_wait.notify();
 
         return res;
     }
 
+    /**
+     * @brief 提交一个已经包装好的任务，不产生 future
+     *
+     * 适合任务图等自行管理完成通知的场景，配合 Task(func, arg) 使用时，
+     * 提交过程不申请任何内存。
+     * @return bool 线程池不在运行状态时返回 false，此时任务不会被执行
+     */
+    bool post(Task &&task)
+    {
+        bool posted = false, handed = false;
+
+        _M_threadLock.lock();
+        if (_M_status.load(std::memory_order_consume) & POOL_RUNNING)
+        {
+            handed = dispatch(std::move(task));
+            posted = true;
+        }
+        _M_threadLock.unlock();
+
+        if (posted && !handed)
+            _M_wait.notify();
+        return posted;
+    }
+
+    /**
+     * @brief 与 post 相同，但线程池暂停或尚未启动时不拒绝任务，
+     *  而是暂存起来，在 start/resume 时提交
+     *
+     * 适合串行执行器、任务图等需要重新提交自己的组件：暂停期间它们让出工作线程，
+     * 恢复后继续执行，而不是转到提交者的线程上执行。
+     * @return bool 只有线程池已经终止时返回 false，此时任务不会被执行
+     */
+    bool postOrDefer(Task &&task)
+    {
+        bool posted = true, notify = false;
+
+        _M_threadLock.lock();
+        PoolStatus status = _M_status.load(std::memory_order_consume);
+        if (status & POOL_RUNNING)
+            notify = !dispatch(std::move(task));
+        else if (status & POOL_TERMINATED)
+            posted = false;
+        else
+            _M_deferred.push_back(std::move(task));
+        _M_threadLock.unlock();
+
+        if (notify)
+            _M_wait.notify();
+        return posted;
+    }
+
+    /**
+     * @brief 将任务提交到指定工作线程的收件箱
+     *
+     * 收件箱中的任务只会由该线程执行，并且优先于共享队列中的任务，
+     * 适合需要线程亲和性的任务。编号超过活动线程数量时按取模选择线程。
+     */
     template <typename F, typename... ArgTp>
-    std::future<typename std::result_of<F(ArgTp...)>::type> submit(F &&f, ArgTp &&...args)
+    Future<typename std::result_of<F(ArgTp...)>::type> submitTo(size_t worker, F &&f, ArgTp &&...args)
     {
         using result_type = typename std::result_of<F(ArgTp...)>::type;
 
-        std::packaged_task<result_type()> task_(std::bind(std::forward<F>(f),
-                                                          std::forward<ArgTp>(args)...));
-        std::future<result_type> res = task_.get_future();
+        auto fn = std::bind(std::forward<F>(f), std::forward<ArgTp>(args)...);
+        PromiseTask<result_type, decltype(fn)> task_(std::move(fn));
+        Future<result_type> res = task_.getFuture();
 
         Task task(std::move(task_));
 
-        // 在添加任务的时候，要确保线程池处于执行状态，且状态不可改变
         _M_threadLock.lock();
         if (_M_status.load(std::memory_order_consume) & POOL_RUNNING)
         {
-            while (!_M_tasks.push(&task, 1))
-            {
-                std::this_thread::yield();
-            }
+            worker %= _M_activeNr.load(std::memory_order_relaxed);
+            enqueue(*_M_inboxes[worker], traced(std::move(task)));
+            _M_threads[worker].kick();
         }
         _M_threadLock.unlock();
 
+        // 只有指定的线程能执行该任务，无法确定唤醒哪一个，因此全部唤醒
+        _M_wait.notifyAll();
+        return res;
+    }
+
+    /**
+     * @brief 创建一个运行在本线程池上的串行执行器
+     *
+     * 提交到同一个 Strand 的任务按顺序执行且不会并发，排队的任务不占用工作线程。
+     * Strand 由线程池持有，线程池析构时一起销毁。
+     */
+    Strand *strand(size_t queueSize = Strand::STRAND_QUEUE_SIZE)
+    {
+        Strand *strand = new Strand(this, queueSize);
+        _M_strandLock.lock();
+        _M_strands.emplace_back(strand);
+        _M_strandLock.unlock();
+        return strand;
+    }
+
+    /**
+     * @brief 分阶段执行 body(phase, index)，每个阶段 taskNr 个任务，阶段之间有全局屏障
+     *
+     * 工作线程在屏障上等待下一个阶段开放后直接继续执行，不再经过任务队列，参见 Phases.h。
+     */
+    template <typename _Fn>
+    void runPhases(size_t taskNr, size_t phaseNr, const _Fn &body)
+    {
+        ::runPhases(*this, taskNr, phaseNr, body);
+    }
+
+    // 每个阶段完成之后（包括最后一个阶段）执行一次 between(phase)
+    template <typename _Fn, typename _Between>
+    void runPhases(size_t taskNr, size_t phaseNr, const _Fn &body, const _Between &between)
+    {
+        ::runPhases(*this, taskNr, phaseNr, body, between);
+    }
+
+    /**
+     * @brief 按键提交任务，键相同的任务按提交顺序串行执行
+     *
+     * 键通过 std::hash 映射到固定数量的串行执行器之一，因此只被同一个键的任务
+     * 访问的状态不需要加锁；不同的键也可能被映射到同一个执行器上串行执行。
+     */
+    template <typename _Key, typename F, typename... ArgTp>
+    Future<typename std::result_of<F(ArgTp...)>::type> submitKeyed(const _Key &key, F &&f, ArgTp &&...args)
+    {
+        return keyedStrand(std::hash<_Key>()(key))->submit(std::forward<F>(f), std::forward<ArgTp>(args)...);
+    }
+
+    template <typename F, typename... ArgTp>
+    Future<typename std::result_of<F(ArgTp...)>::type> submit(F &&f, ArgTp &&...args)
+    {
+        using result_type = typename std::result_of<F(ArgTp...)>::type;
+
+        auto fn = std::bind(std::forward<F>(f), std::forward<ArgTp>(args)...);
+        PromiseTask<result_type, decltype(fn)> task_(std::move(fn));
+        Future<result_type> res = task_.getFuture();
+
+        Task task(std::move(task_));
+
+        // 在添加任务的时候，要确保线程池处于执行状态，且状态不可改变；
+        // 有空闲的工作线程时直接交付，只唤醒这一个线程
+        bool handed = false;
+        _M_threadLock.lock();
+        if (_M_status.load(std::memory_order_consume) & POOL_RUNNING)
+        {
+            handed = dispatch(std::move(task));
+        }
+        _M_threadLock.unlock();
+        if (!handed)
+            _M_wait.notify();
+
         return res;
     }
 };
 
+/* 默认策略下的线程和线程池，与之前的 Thread 和 ThreadManager 行为一致 */
+using Thread = BasicThread<LockFreeQueue<Task>>;
+using ThreadManager = BasicThreadManager<>;
+
+/* ------------------------------- BasicThread ------------------------------- */
+
+template <typename _Queue, typename _Wait, typename _Stats>
+thread_local BasicThread<_Queue, _Wait, _Stats> *BasicThread<_Queue, _Wait, _Stats>::_S_current = nullptr;
+
+template <typename _Queue, typename _Wait, typename _Stats>
+BasicThread<_Queue, _Wait, _Stats>::~BasicThread()
+{
+    shutdown();
+}
+
+template <typename _Queue, typename _Wait, typename _Stats>
+void BasicThread<_Queue, _Wait, _Stats>::run()
+{
+    _S_current = this;
+    unsigned idleRound = 0; // 连续取不到任务的次数，交给等待策略决定如何等待
+    while (_M_status.load(std::memory_order_consume) &
+           (~THREAD_TERMINATED))
+    {
+        switch (_M_status.load())
+        {
+        case THREAD_RUNNING:
+        { // 大括号保证代码中使用的全部是局部变量
+            // 线程池整体暂停时，在闸门上睡眠，醒来后重新检查状态
+            if (_M_gate && _M_gate->closed())
+            {
+                _M_gate->wait();
+                break;
+            }
+            // 当线程的状态为运行时，优先执行直接交付的任务，然后从队列中获取一个任务执行
+            Task task;
+            if (takeHandoff(task))
+            {
+                idleRound = 0;
+                execute(task);
+            }
+            else if ((_M_inbox && _M_inbox->tryPop(task)) ||
+                     _M_taskQue->tryPop(task))
+            {
+                idleRound = 0;
+                // 撤销失败说明同时有任务交付过来，它在下一轮执行
+                disarm();
+                execute(task);
+            }
+            else
+            {
+                _M_stats->onIdle();
+                if (trimPending())
+                    trim();
+                if (_M_idleNr)
+                {
+                    arm();
+                    _M_wait->wait(idleRound++, [this]
+                                  { return hasWork(); },
+                                  _M_handoff);
+                }
+                else
+                {
+                    _M_wait->wait(idleRound++, [this]
+                                  { return hasWork(); });
+                }
+            }
+        }
+        break;
+        case THREAD_CREATED:
+        case THREAD_PAUSE:
+        {
+            // 暂停前已经交付过来的任务仍然执行，之后不再接受交付
+            if (!disarm())
+            {
+                Task task;
+                if (takeHandoff(task))
+                    execute(task);
+                break;
+            }
+            // 收件箱中的任务只有本线程能执行，收缩前已经提交的任务执行完再睡眠；
+            // 线程池整体暂停时同样先在闸门上等待
+            if (_M_inbox && !_M_inbox->empty())
+            {
+                if (_M_gate && _M_gate->closed())
+                {
+                    _M_gate->wait();
+                    break;
+                }
+                Task task;
+                if (_M_inbox->tryPop(task))
+                    execute(task);
+                break;
+            }
+            // 等待期间状态可能已经被改变，带条件等待避免丢失唤醒
+            std::unique_lock<std::mutex> lock(_M_mutex);
+            _M_cond.wait(lock, [this]
+                         { return !(_M_status.load() & (THREAD_CREATED | THREAD_PAUSE)) || trimPending(); });
+            lock.unlock();
+            if (trimPending())
+                trim();
+        }
+        break;
+        }
+    }
+}
+
+template <typename _Queue, typename _Wait, typename _Stats>
+void BasicThread<_Queue, _Wait, _Stats>::start()
+{
+    int expectStatus = THREAD_CREATED;
+    if (_M_status.compare_exchange_strong(
+            expectStatus, THREAD_RUNNING,
+            std::memory_order_acq_rel))
+    {
+        // 只有从 CREATED 状态到 RUNNING 状态
+        // 才允许真正开始工作
+        wake();
+    }
+}
+
+template <typename _Queue, typename _Wait, typename _Stats>
+void BasicThread<_Queue, _Wait, _Stats>::pause()
+{
+    int expectStatus = _M_status;
+    if (expectStatus & (THREAD_PAUSE | THREAD_TERMINATED))
+        return;
+    if (_M_status.compare_exchange_strong(
+            expectStatus, THREAD_PAUSE,
+            std::memory_order_acq_rel))
+    {
+        // 线程可能正在等待策略中或者邮箱上睡眠，唤醒后转到条件变量上等待，
+        // 避免之后提交任务时唤醒的是一个已经暂停的线程
+        _M_wait->notifyAll();
+        kick();
+    }
+}
+
+template <typename _Queue, typename _Wait, typename _Stats>
+void BasicThread<_Queue, _Wait, _Stats>::resume()
+{
+    int expectStatus = _M_status;
+    if (expectStatus & (THREAD_RUNNING | THREAD_TERMINATED))
+        return;
+    if (_M_status.compare_exchange_strong(
+            expectStatus, THREAD_RUNNING,
+            std::memory_order_acq_rel))
+    {
+        wake();
+    }
+}
+
+template <typename _Queue, typename _Wait, typename _Stats>
+void BasicThread<_Queue, _Wait, _Stats>::shutdown()
+{
+    int expectStatus = _M_status.load(std::memory_order_consume);
+
+    if (expectStatus & THREAD_TERMINATED)
+    {
+        return;
+    }
+    if (_M_status.compare_exchange_strong(
+            expectStatus, THREAD_TERMINATED,
+            std::memory_order_acq_rel))
+    {
+        // 要确保首先转换状态，只完成正在执行的任务即可，
+        // 如果暂停或者还没开始，则直接唤醒并结束即可；
+        // 如果正在等待策略中睡眠，也需要唤醒
+        if (expectStatus & (THREAD_CREATED | THREAD_PAUSE))
+        {
+            wake();
+        }
+        else
+        {
+            _M_wait->notifyAll();
+            kick();
+        }
+        // 只有当线程状态成功被转为终止态,
+        // 并且线程可以被终止才实现回收
+        if (_M_thread.joinable())
+        {
+            _M_thread.join();
+        }
+    }
+
+#ifndef NDEBUG
+    printf("[INFO] Thread: Shutted.\n");
+#endif
+}
+
+/* ---------------------------- BasicThreadManager ---------------------------- */
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+const size_t BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::coreNr = std::thread::hardware_concurrency();
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+constexpr size_t BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::COMPENSATOR_MAX;
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+constexpr size_t BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::WORKER_NONE;
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::~BasicThreadManager()
+{
+    if (_M_status.load(std::memory_order_consume) &
+        (~POOL_TERMINATED))
+    {
+        shutdown();
+    }
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::manage()
+{
+    std::chrono::steady_clock::time_point idleSince;
+    bool trimmed = false;
+
+    // 管理工作线程
+    while (_M_status.load(std::memory_order_consume) &
+           (~POOL_TERMINATED))
+    {
+        switch (_M_status.load())
+        {
+        case POOL_RUNNING:
+        {
+            // 当线程池正在运行时，不断查看当前队列的压力，
+            // 当压力增大时，增加活动工作线程的数量，否则减少，
+            // 正在运行的线程数量不能少于CPU核心数
+            _M_threadLock.lock();
+            // 由于 vector 不能保证线程安全，因此操作时，
+            // 应该首先加锁，并且需要保证当前线程池不是
+            // 暂停、终止或开始
+            if (_M_status.load(std::memory_order_consume) &
+                POOL_RUNNING)
+            {
+                size_t expectNr = (int)getStress() * _M_poolSize;
+                size_t nowNr = _M_activeNr;
+                if (expectNr >= 2 && nowNr != expectNr &&
+                    _M_activeNr.compare_exchange_strong(
+                        nowNr, expectNr,
+                        std::memory_order_acq_rel))
+                {
+                    // 下标小于 expectNr 的线程保持运行，submitTo 只会选择它们
+                    if (nowNr > expectNr)
+                    {
+                        for (size_t i = expectNr; i < nowNr; i++)
+                        {
+                            _M_threads[i].pause();
+                        }
+                    }
+                    else
+                    {
+                        for (size_t i = nowNr; i < expectNr; i++)
+                        {
+                            _M_threads[i].resume();
+                        }
+                    }
+                }
+            }
+            _M_threadLock.unlock();
+
+            if (_M_options.idleTrim.count() > 0)
+                trimIfIdle(idleSince, trimmed);
+            _M_wait.pace();
+        }
+        break;
+        case POOL_PAUSE:
+            _M_gate.wait();
+            break;
+        case POOL_CREATED:
+        {
+            std::unique_lock<std::mutex> lock(_M_mutex);
+            _M_cond.wait(lock, [this]
+                         { return !(_M_status.load() & POOL_CREATED); });
+        }
+        break;
+        }
+    }
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: Manager of pool ended!\n");
+#endif
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::trimIfIdle(
+    std::chrono::steady_clock::time_point &idleSince, bool &trimmed)
+{
+    // 空闲以管理线程的采样为准，两次采样之间完成的短暂任务可能被忽略，
+    // 这只会使回收提前，之后的任务会重新分配需要的内存
+    if (_M_inFlight.count())
+    {
+        idleSince = std::chrono::steady_clock::time_point();
+        trimmed = false;
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (idleSince == std::chrono::steady_clock::time_point())
+    {
+        idleSince = now;
+        return;
+    }
+    if (trimmed || now - idleSince < _M_options.idleTrim)
+        return;
+
+    trimmed = true;
+    size_t released = trim();
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: Idle for %lld ms, %lu bytes of the queues released.\n",
+           (long long)_M_options.idleTrim.count(), released);
+#else
+    (void)released;
+#endif
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+size_t BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::trim()
+{
+    size_t released = 0;
+
+    _M_threadLock.lock();
+    if (!(_M_status.load(std::memory_order_consume) & POOL_TERMINATED))
+    {
+        // 提交任务都需要持有 _M_threadLock，因此期间不会有并发的写入（NullLock 除外，
+        // 此时只能由唯一的提交线程调用）；仍在出队的读者会使队列跳过本次回收
+        released = _M_tasks.trim();
+        // submitTo 同样持有 _M_threadLock，收件箱此时只有工作线程自己在读
+        for (auto &inbox : _M_inboxes)
+        {
+            released += inbox->trim();
+        }
+        _M_trimEpoch.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < _M_poolSize; i++)
+        {
+            _M_threads[i].requestTrim();
+        }
+        _M_compensatorLock.lock();
+        for (auto &compensator : _M_compensators)
+        {
+            compensator->requestTrim();
+        }
+        _M_compensatorLock.unlock();
+    }
+    _M_threadLock.unlock();
+
+    // 在等待策略中睡眠的线程被唤醒后，取不到任务时回收
+    _M_wait.notifyAll();
+    return released;
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+bool BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::beginBlocking()
+{
+    _Thread *self = _Thread::current();
+    if (!self || self->getOwner() != this)
+        return false;
+
+    size_t blocked = _M_blockedNr.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    _M_compensatorLock.lock();
+    // 只有运行中的线程池需要补偿，每个阻塞的工作线程对应一个运行中的补偿线程
+    if (_M_status.load(std::memory_order_consume) & POOL_RUNNING)
+    {
+        while (_M_compensatorNr < std::min(blocked, COMPENSATOR_MAX))
+        {
+            if (_M_compensatorNr == _M_compensators.size())
+            {
+                _Thread *compensator = new _Thread();
+                compensator->setOwner(this);
+                compensator->setIndex(_M_poolSize + _M_compensators.size());
+                compensator->setGate(&_M_gate);
+                compensator->setAttr(ThreadAttr(_M_options.stackSize, _M_options.guardSize));
+                compensator->setTrim(&_M_trimEpoch);
+                compensator->setPolicy(&_M_wait, &_M_stats);
+                compensator->setQue(&_M_tasks, &_M_inFlight);
+                _M_compensators.emplace_back(compensator);
+                compensator->start();
+#ifndef NDEBUG
+                printf("[INFO] ThreadPool: Compensating thread %lu spawned for a blocking task.\n",
+                       _M_compensators.size());
+#endif
+            }
+            else
+            {
+                _M_compensators[_M_compensatorNr]->resume();
+            }
+            _M_compensatorNr++;
+        }
+    }
+    _M_compensatorLock.unlock();
+
+    return true;
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::endBlocking()
+{
+    size_t blocked = _M_blockedNr.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+    _M_compensatorLock.lock();
+    // 退役最后激活的补偿线程，它会在完成手头的任务后暂停
+    if (!(_M_status.load(std::memory_order_consume) & POOL_TERMINATED))
+    {
+        while (_M_compensatorNr > blocked)
+        {
+            _M_compensators[--_M_compensatorNr]->pause();
+        }
+    }
+    _M_compensatorLock.unlock();
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+Strand *BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::keyedStrand(size_t hash)
+{
+    std::atomic<Strand *> &slot = _M_keyed[hash % KEYED_STRAND_NR];
+    Strand *strand = slot.load(std::memory_order_acquire);
+    if (strand)
+        return strand;
+
+    // 双重检查，保证每个槽位只创建一次
+    _M_strandLock.lock();
+    strand = slot.load(std::memory_order_relaxed);
+    if (!strand)
+    {
+        strand = new Strand(this);
+        _M_strands.emplace_back(strand);
+        slot.store(strand, std::memory_order_release);
+    }
+    _M_strandLock.unlock();
+    return strand;
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::start()
+{
+    int expectStatus = POOL_CREATED;
+    bool flushed = false;
+    _M_threadLock.lock();
+    if (_M_status.compare_exchange_strong(
+            expectStatus, POOL_RUNNING,
+            std::memory_order_acq_rel))
+    {
+        // 只有从 CREATED 状态到 RUNNING 状态
+        // 才允许真正开始工作
+        _M_activeNr.store(std::min(std::max((size_t)2, coreNr), _M_poolSize),
+                          std::memory_order_release);
+        for (size_t i = 0; i < _M_activeNr; i++)
+        {
+            _M_threads[i].start();
+        }
+        flushed = flushDeferred();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_M_mutex);
+        _M_cond.notify_one();
+    }
+    _M_threadLock.unlock();
+    if (flushed)
+        _M_wait.notifyAll();
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: %lu thread(s) and the Manager has started!\n", _M_activeNr.load(std::memory_order_relaxed));
+#endif
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::pause()
+{
+    int expectStatus = _M_status;
+    if (expectStatus & (POOL_PAUSE | POOL_TERMINATED))
+        return;
+
+    _M_threadLock.lock();
+    if (_M_status.compare_exchange_strong(
+            expectStatus, POOL_PAUSE,
+            std::memory_order_acq_rel))
+    {
+        // 只关闭闸门，不逐个暂停线程；
+        // 线程完成手头的任务后，在闸门上睡眠
+        _M_gate.close();
+    }
+    _M_threadLock.unlock();
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::resume()
+{
+    int expectStatus = POOL_PAUSE;
+    bool flushed = false;
+
+    _M_threadLock.lock();
+    if (_M_status.compare_exchange_strong(
+            expectStatus, POOL_RUNNING,
+            std::memory_order::memory_order_acq_rel))
+    {
+        // 打开闸门时一次唤醒全部睡眠的线程，包括管理线程
+        _M_gate.open();
+        flushed = flushDeferred();
+    }
+    _M_threadLock.unlock();
+    if (flushed)
+        _M_wait.notifyAll();
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+size_t BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::queuedNr() const
+{
+    size_t queued = _M_tasks.size();
+    for (auto &inbox : _M_inboxes)
+    {
+        queued += inbox->size();
+    }
+    // 已经交付到邮箱但还没有被取走的任务
+    for (auto &thread : _M_threads)
+    {
+        queued += thread.handoffPending();
+    }
+    return queued;
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::drainInboxes()
+{
+    // 收件箱中的任务只能由对应的线程执行，排空前需要唤醒这些线程
+    _M_threadLock.lock();
+    if (_M_status.load(std::memory_order_consume) & POOL_RUNNING)
+    {
+        for (size_t i = 0; i < _M_poolSize; i++)
+        {
+            if (!_M_inboxes[i]->empty())
+            {
+                _M_threads[i].start();
+                _M_threads[i].resume();
+                _M_threads[i].kick();
+            }
+        }
+    }
+    _M_threadLock.unlock();
+    _M_wait.notifyAll();
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::shutdown()
+{
+    // 暂停的线程池无法排空队列，需要先恢复执行；尚未启动时推迟的任务需要启动后执行
+    startIfDeferred();
+    resume();
+    drainInboxes();
+
+    // 在全部强制关闭前，首先确保队列为空并且正在执行的任务全部完成，
+    // 等待过程由闩锁唤醒，不再忙等
+    _M_inFlight.wait();
+
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: All tasks finished. Pool is shutting...\n");
+#endif
+
+    // 已经将所有队列的任务都执行完成，直接结束即可
+    forceShutdown();
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+ShutdownReport BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::shutdownFor(std::chrono::nanoseconds timeout)
+{
+    startIfDeferred();
+    resume();
+    drainInboxes();
+
+    ShutdownReport report;
+    report.drained = _M_inFlight.waitFor(timeout);
+    report.queued = report.running = 0;
+    if (report.drained)
+    {
+        forceShutdown();
+        return report;
+    }
+
+    // 截止时刻的快照：在途任务中不在队列里的，就是已经取出正在执行的
+    size_t inFlight = _M_inFlight.count();
+    report.running = inFlight - std::min(queuedNr(), inFlight);
+
+    // 强制关闭会等待正在执行的任务结束，队列中剩余的任务则被丢弃
+    forceShutdown();
+    report.queued = queuedNr();
+
+#ifndef NDEBUG
+    printf("\033[33m[WARNING] ThreadPool: Shutdown timed out with %lu queued and %lu running task(s)!\033[0m\n",
+           report.queued, report.running);
+#endif
+    return report;
+}
+
+template <typename _Queue, typename _Wait, typename _Stats, typename _Lock>
+void BasicThreadManager<_Queue, _Wait, _Stats, _Lock>::forceShutdown()
+{
+    PoolStatus expectStatus = _M_status.load(std::memory_order_consume);
+    if (expectStatus & POOL_TERMINATED)
+        return;
+
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: Waiting the spin lock for shutting...\n");
+#endif
+
+    _M_threadLock.lock();
+
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: Start shutting the thread pool...\n");
+#endif
+
+    if (_M_status.compare_exchange_strong(
+            expectStatus, POOL_TERMINATED,
+            std::memory_order_acq_rel))
+    {
+        // 管理线程可能还在等待线程池启动或恢复
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            _M_cond.notify_one();
+        }
+        _M_gate.open();
+        // 要确保首先转换状态，直接全部结束即可
+        for (size_t i = 0; i < _M_poolSize; i++)
+        {
+            _M_threads[i].shutdown();
+        }
+        // 状态已经是终止态，之后不会再创建补偿线程；
+        // 回收时不能持有锁，因为补偿线程的任务可能正要退出阻塞区间
+        _M_compensatorLock.lock();
+        _M_compensatorLock.unlock();
+        for (auto &compensator : _M_compensators)
+        {
+            compensator->shutdown();
+        }
+        // 推迟的任务不会再有机会执行
+        _M_deferred.clear();
+    }
+
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: All threads is shutted!\n");
+#endif
+    _M_threadLock.unlock();
+    if (_M_manager.joinable())
+        _M_manager.join();
+
+#ifndef NDEBUG
+    printf("[INFO] ThreadPool: Shutted!\n");
+#endif
+}
+
+/* 默认策略的实例化放在库中完成，使用者不必重复编译 */
+extern template class BasicThread<LockFreeQueue<Task>, YieldWait, NoStats>;
+extern template class BasicThreadManager<LockFreeQueue<Task>, YieldWait, NoStats, spinLock>;
+
 #endif
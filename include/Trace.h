@@ -0,0 +1,224 @@
+/**
+ * @file Trace.h
+ * @author Xu.Cao
+ * @details
+ *  本文件提供负载的采集和回放，用于离线比较不同的线程池配置：
+ * - TraceRecorder：设置到线程池后，记录每个任务的提交时刻、执行时长和提交线程，
+ *   可以保存为紧凑的二进制文件（每个任务 16 字节）；
+ * - BusyWork：经过校准的空转计算，按指定的时长占用 CPU；
+ * - replayTrace：按照记录的到达时刻，在任意配置的线程池上用 BusyWork 重放任务，
+ *   报告吞吐量、排队延迟的分位数以及消耗的 CPU 时间。
+ * tools/TraceReplay 是对 replayTrace 的命令行封装。
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include "Task.h"
+#include "Latch.h"
+
+constexpr size_t TRACE_CAPACITY_DEFAULT = 1 << 20;
+constexpr size_t TRACE_REPLAY_THREADS_MAX = 64; // 回放时提交线程的数量上限
+
+/**
+ * 一个任务的记录。
+ * - submit：提交时刻，相对于开始采集的纳秒数；
+ * - duration：执行时长的纳秒数，超过 uint32_t 范围时饱和；
+ * - thread：提交线程的编号，按线程第一次提交的顺序分配。
+ */
+struct TraceRecord
+{
+    uint64_t submit;
+    uint32_t duration;
+    uint32_t thread;
+};
+
+static_assert(sizeof(TraceRecord) == 16, "trace records must stay compact");
+
+// 当前线程在采集中的编号
+uint32_t traceThreadId();
+
+/**
+ * @class TraceRecorder
+ * @brief 预先分配固定数量的记录，写满后丢弃之后的记录
+ *
+ * 采集期间每个任务会被包装一次（申请一次内存），只适合在采集时开启。
+ * 包装后的任务持有原任务，被拒绝或丢弃时一起释放。
+ * 记录器需要晚于线程池中被记录的任务结束。
+ */
+class TraceRecorder final
+{
+    // 带计时的任务，满足 Task 对 PromiseTask 的要求：提供 valid() 和 operator()
+    struct Entry
+    {
+        TraceRecorder *recorder;
+        Task task;
+        uint64_t submit;
+        uint32_t thread;
+
+        bool valid() const { return recorder != nullptr; }
+
+        void operator()();
+    };
+
+    std::vector<TraceRecord> _M_records;
+    std::atomic<size_t> _M_size;
+    std::atomic<size_t> _M_dropped;
+    std::chrono::steady_clock::time_point _M_origin;
+
+    uint64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - _M_origin)
+            .count();
+    }
+
+    void record(uint64_t submit, uint64_t duration, uint32_t thread);
+
+public:
+    explicit TraceRecorder(size_t capacity = TRACE_CAPACITY_DEFAULT);
+
+    TraceRecorder(const TraceRecorder &other) = delete;
+    TraceRecorder &operator=(const TraceRecorder &other) = delete;
+
+    // 将任务包装为带计时的任务，在提交线程中调用
+    Task wrap(Task &&task);
+
+    size_t size() const { return std::min(_M_size.load(std::memory_order_acquire), _M_records.size()); }
+
+    // 因为记录已满而丢弃的任务数量
+    size_t dropped() const { return _M_dropped.load(std::memory_order_relaxed); }
+
+    // 按提交时刻排序的记录，需要在被记录的任务全部结束后调用
+    std::vector<TraceRecord> records() const;
+
+    // 保存为二进制文件，需要在被记录的任务全部结束后调用
+    bool save(const char *path) const;
+};
+
+// 读取 TraceRecorder::save 保存的文件，格式不正确时返回 false
+bool loadTrace(const char *path, std::vector<TraceRecord> &records);
+
+/**
+ * @class BusyWork
+ * @brief 构造时测量空转循环的速度，之后按时长换算为循环次数执行
+ */
+class BusyWork final
+{
+    double _M_perNs; // 每纳秒的循环次数
+
+public:
+    BusyWork();
+
+    void run(uint64_t ns) const;
+
+    static uint64_t spin(uint64_t iterations);
+};
+
+/**
+ * 回放的结果，延迟是任务从提交到开始执行的时间。
+ */
+struct ReplayReport
+{
+    size_t tasks;
+    size_t dropped; // 线程池拒绝的任务数量
+    double seconds;
+    double throughput; // 每秒完成的任务数量
+    uint64_t delayP50;
+    uint64_t delayP90;
+    uint64_t delayP99;
+    uint64_t delayMax;
+    double cpuSeconds; // 进程消耗的用户态和内核态 CPU 时间，包括提交线程
+};
+
+// 进程到目前为止消耗的 CPU 时间
+double processCpuSeconds();
+
+namespace detail
+{
+    struct ReplaySlot
+    {
+        const TraceRecord *record;
+        const BusyWork *work;
+        Latch *done;
+        std::chrono::steady_clock::time_point submitted;
+        uint64_t delay;
+        bool executed; // 被线程池拒绝的任务不参与统计
+    };
+
+    void replayOne(void *arg);
+
+    // 计算排队延迟的分位数等统计结果
+    void summarize(std::vector<ReplaySlot> &slots, ReplayReport &report);
+}
+
+/**
+ * @brief 在 manager 上按记录的到达时刻重放任务，阻塞直到全部任务完成
+ *
+ * 每个原始的提交线程对应一个回放线程（超过 TRACE_REPLAY_THREADS_MAX 时取模合并），
+ * 按 submit / speed 的时刻提交；任务执行 duration 纳秒的 BusyWork。
+ * 线程池需要提供 bool post(Task &&)。
+ */
+template <typename _Manager>
+ReplayReport replayTrace(_Manager &manager, const std::vector<TraceRecord> &records,
+                         const BusyWork &work, double speed = 1.0)
+{
+    using namespace std::chrono;
+
+    ReplayReport report = ReplayReport();
+    report.tasks = records.size();
+
+    Latch done;
+    done.add(records.size());
+    std::vector<detail::ReplaySlot> slots(records.size());
+    std::vector<std::vector<size_t>> byThread(TRACE_REPLAY_THREADS_MAX);
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        slots[i].record = &records[i];
+        slots[i].work = &work;
+        slots[i].done = &done;
+        slots[i].delay = 0;
+        slots[i].executed = false;
+        byThread[records[i].thread % TRACE_REPLAY_THREADS_MAX].push_back(i);
+    }
+
+    std::atomic<size_t> dropped(0);
+    double cpuStart = processCpuSeconds();
+    steady_clock::time_point origin = steady_clock::now();
+
+    std::vector<std::thread> submitters;
+    for (auto &indexes : byThread)
+    {
+        if (indexes.empty())
+            continue;
+        submitters.emplace_back([&, speed]
+                                {
+            for (size_t i : indexes)
+            {
+                detail::ReplaySlot &slot = slots[i];
+                std::this_thread::sleep_until(origin + nanoseconds((uint64_t)(slot.record->submit / speed)));
+                slot.submitted = steady_clock::now();
+                if (!manager.post(Task(&detail::replayOne, &slot)))
+                {
+                    dropped++;
+                    done.done();
+                }
+            } });
+    }
+    for (auto &submitter : submitters)
+        submitter.join();
+    done.wait();
+
+    report.seconds = duration<double>(steady_clock::now() - origin).count();
+    report.cpuSeconds = processCpuSeconds() - cpuStart;
+    report.dropped = dropped.load();
+    detail::summarize(slots, report);
+    return report;
+}
+
+#endif
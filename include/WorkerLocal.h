@@ -0,0 +1,176 @@
+/**
+ * @file WorkerLocal.h
+ * @author Xu.Cao
+ * @details
+ *  本文件定义了工作线程私有的存储：
+ * - Arena：按块申请内存的线性分配器，分配只移动指针，reset 后整体回收并复用已有的块；
+ * - WorkerStorage：每个工作线程一份，按类型保存懒构造的对象，并内置一个 Arena。
+ * 工作线程每执行完一个任务都会重置自己的 Arena，因此任务中的临时内存不需要调用 malloc。
+ */
+#ifndef WORKER_LOCAL_H
+#define WORKER_LOCAL_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+/**
+ * @class Arena
+ * @brief 线性分配器，只能整体释放
+ *
+ * 通过 create 构造的对象不会被析构，适合存放平凡析构的临时数据。
+ */
+class Arena final
+{
+    struct Block
+    {
+        Block *next;
+        size_t size; // 数据区的大小
+    };
+
+    // 块头之后的数据区按 max_align_t 对齐
+    static constexpr size_t HEADER_SIZE =
+        (sizeof(Block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    Block *_M_head;    // 第一个块，第一次分配时才申请
+    Block *_M_current; // 正在使用的块，之后的块在 reset 后被复用
+    char *_M_ptr;
+    char *_M_end;
+    size_t _M_blockSize;
+
+    static char *data(Block *block) { return reinterpret_cast<char *>(block) + HEADER_SIZE; }
+
+    void *allocateSlow(size_t size, size_t align);
+
+public:
+    explicit Arena(size_t blockSize = ARENA_BLOCK_SIZE)
+        : _M_head(nullptr), _M_current(nullptr), _M_ptr(nullptr), _M_end(nullptr),
+          _M_blockSize(blockSize) {}
+
+    ~Arena();
+
+    Arena(const Arena &other) = delete;
+    Arena &operator=(const Arena &other) = delete;
+
+    /**
+     * @param align 必须是 2 的幂
+     */
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        uintptr_t ptr = (reinterpret_cast<uintptr_t>(_M_ptr) + align - 1) & ~(uintptr_t)(align - 1);
+        if (_M_ptr && ptr + size <= reinterpret_cast<uintptr_t>(_M_end))
+        {
+            _M_ptr = reinterpret_cast<char *>(ptr + size);
+            return reinterpret_cast<void *>(ptr);
+        }
+        return allocateSlow(size, align);
+    }
+
+    template <typename _Ty, typename... ArgTp>
+    _Ty *create(ArgTp &&...args)
+    {
+        return new (allocate(sizeof(_Ty), alignof(_Ty))) _Ty(std::forward<ArgTp>(args)...);
+    }
+
+    template <typename _Ty>
+    _Ty *allocateArray(size_t nr)
+    {
+        return static_cast<_Ty *>(allocate(sizeof(_Ty) * nr, alignof(_Ty)));
+    }
+
+    // 回收全部内存，保留已经申请的块供之后复用
+    void reset()
+    {
+        if (_M_current != _M_head || (_M_head && _M_ptr != data(_M_head)))
+        {
+            _M_current = _M_head;
+            _M_ptr = data(_M_head);
+            _M_end = _M_ptr + _M_head->size;
+        }
+    }
+
+    // 释放全部块，之后的分配重新申请
+    void release();
+
+    // 已经申请的块占用的内存总量
+    size_t capacity() const;
+};
+
+size_t nextWorkerLocalId();
+
+// 每个类型在第一次使用时分配一个编号，作为 WorkerStorage 中的下标
+template <typename _Ty>
+size_t workerLocalId()
+{
+    static const size_t id = nextWorkerLocalId();
+    return id;
+}
+
+/**
+ * @class WorkerStorage
+ * @brief 一个工作线程私有的对象表和 Arena
+ *
+ * 对象只能由所属的工作线程构造；其他线程只应该在线程池空闲时通过 find 读取。
+ */
+class WorkerStorage final
+{
+    struct Entry
+    {
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    std::vector<Entry> _M_objects;
+    Arena _M_arena;
+
+    template <typename _Ty>
+    static void destroy(void *object) { delete static_cast<_Ty *>(object); }
+
+public:
+    WorkerStorage() = default;
+
+    ~WorkerStorage()
+    {
+        for (Entry &entry : _M_objects)
+        {
+            if (entry.object)
+                entry.destroy(entry.object);
+        }
+    }
+
+    WorkerStorage(const WorkerStorage &other) = delete;
+    WorkerStorage &operator=(const WorkerStorage &other) = delete;
+
+    // 获取本线程的 _Ty 对象，第一次获取时默认构造
+    template <typename _Ty>
+    _Ty &get()
+    {
+        size_t id = workerLocalId<_Ty>();
+        if (id >= _M_objects.size())
+            _M_objects.resize(id + 1, Entry{nullptr, nullptr});
+        Entry &entry = _M_objects[id];
+        if (!entry.object)
+        {
+            entry.object = new _Ty();
+            entry.destroy = &WorkerStorage::destroy<_Ty>;
+        }
+        return *static_cast<_Ty *>(entry.object);
+    }
+
+    // 查找已经构造的 _Ty 对象，尚未构造时返回 nullptr
+    template <typename _Ty>
+    _Ty *find() const
+    {
+        size_t id = workerLocalId<_Ty>();
+        return id < _M_objects.size() ? static_cast<_Ty *>(_M_objects[id].object) : nullptr;
+    }
+
+    Arena &arena() { return _M_arena; }
+};
+
+#endif
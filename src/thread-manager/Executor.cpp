@@ -0,0 +1,202 @@
+#include "Executor.h"
+#include "Futex.h"
+
+#ifndef NDEBUG
+#include <stdio.h>
+#endif
+
+bool Executor::post(Task &&task)
+{
+    // 先计数再检查状态，与 shutdown 先改状态再等待计数相对应，
+    // 保证关闭时要么拒绝任务，要么等待它执行完成
+    _M_inFlight.add();
+    if (_M_group->_M_stop.load())
+    {
+        _M_inFlight.done();
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] Executor: Task appended failed, 'cause the group is shutted!\033[0m\n");
+#endif
+        return false;
+    }
+
+    while (!_M_tasks.tryPush(std::move(task)))
+    {
+        std::this_thread::yield();
+    }
+    _M_group->notify();
+    return true;
+}
+
+ExecutorGroup::ExecutorGroup(size_t workerNr)
+    : _M_executorNr(0), _M_vclock(0), _M_stop(false),
+      _M_idleNr(0), _M_signal(0)
+{
+    if (!workerNr)
+        workerNr = 1;
+    _M_workers.reserve(workerNr);
+    for (size_t i = 0; i < workerNr; i++)
+    {
+        _M_workers.emplace_back(&ExecutorGroup::run, this, i);
+    }
+
+#ifndef NDEBUG
+    printf("[INFO] ExecutorGroup: Initialized with %lu shared worker(s)!\n", workerNr);
+#endif
+}
+
+ExecutorGroup::~ExecutorGroup()
+{
+    shutdown();
+}
+
+Executor *ExecutorGroup::create(unsigned weight, size_t minShare, size_t maxShare,
+                                size_t queueSize)
+{
+    Executor *executor = nullptr;
+
+    _M_lock.lock();
+    size_t nr = _M_executorNr.load(std::memory_order_relaxed);
+    if (nr < EXECUTOR_MAX && !_M_stop.load(std::memory_order_acquire))
+    {
+        _M_executors[nr].reset(new Executor(this, weight, minShare, maxShare, queueSize));
+        executor = _M_executors[nr].get();
+        // 先构造完成，再公布数量，工作线程只会看到完整的执行器
+        _M_executorNr.store(nr + 1, std::memory_order_release);
+    }
+    _M_lock.unlock();
+
+#ifndef NDEBUG
+    if (!executor)
+        printf("\033[33m[WARNING] ExecutorGroup: Executor created failed!\033[0m\n");
+#endif
+    return executor;
+}
+
+void ExecutorGroup::notify()
+{
+    // 与工作线程睡眠前的检查构成 Dekker 式的同步，保证不会丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_M_idleNr.load(std::memory_order_relaxed))
+    {
+        _M_signal.fetch_add(1, std::memory_order_release);
+        futexWake(&_M_signal, 1);
+    }
+}
+
+bool ExecutorGroup::hasWork() const
+{
+    size_t nr = _M_executorNr.load(std::memory_order_acquire);
+    for (size_t i = 0; i < nr; i++)
+    {
+        const Executor *executor = _M_executors[i].get();
+        if (!executor->_M_tasks.empty() &&
+            executor->_M_running.load(std::memory_order_relaxed) < executor->_M_maxShare)
+            return true;
+    }
+    return false;
+}
+
+Executor *ExecutorGroup::pick(size_t start)
+{
+    size_t nr = _M_executorNr.load(std::memory_order_acquire);
+    if (!nr)
+        return nullptr;
+
+    // 1. 优先满足尚未达到最小份额的执行器；
+    // 2. 否则在未达到最大份额的执行器中，选择虚拟时间最小的一个
+    Executor *best = nullptr;
+    uint64_t bestTime = UINT64_MAX;
+    uint64_t clock = _M_vclock.load(std::memory_order_relaxed);
+    for (size_t k = 0; k < nr; k++)
+    {
+        Executor *executor = _M_executors[(start + k) % nr].get();
+        if (executor->_M_tasks.empty())
+            continue;
+
+        if (executor->_M_running.load(std::memory_order_relaxed) < executor->_M_minShare &&
+            executor->acquire(executor->_M_minShare))
+            return executor;
+
+        // 刚刚变得活跃的执行器从当前虚拟时间开始计时，不能凭借积累的空闲时间独占工作线程
+        uint64_t vtime = std::max(executor->_M_vtime.load(std::memory_order_relaxed), clock);
+        if (vtime < bestTime &&
+            executor->_M_running.load(std::memory_order_relaxed) < executor->_M_maxShare)
+        {
+            best = executor;
+            bestTime = vtime;
+        }
+    }
+
+    if (!best || !best->acquire(best->_M_maxShare))
+        return nullptr;
+
+    // 虚拟时间只用于近似的公平性，这里允许并发更新时的少量误差
+    best->_M_vtime.store(bestTime + best->_M_stride, std::memory_order_relaxed);
+    if (bestTime > clock)
+        _M_vclock.store(bestTime, std::memory_order_relaxed);
+    return best;
+}
+
+void ExecutorGroup::run(size_t index)
+{
+    while (true)
+    {
+        Executor *executor = pick(index);
+        if (executor)
+        {
+            Task task;
+            if (executor->_M_tasks.tryPop(task))
+            {
+                task();
+                executor->_M_running.fetch_sub(1, std::memory_order_acq_rel);
+                executor->_M_inFlight.done();
+                // 达到最大份额时其他线程可能在睡眠，释放份额后需要唤醒它们
+                if (!executor->_M_tasks.empty())
+                    notify();
+            }
+            else
+            {
+                executor->_M_running.fetch_sub(1, std::memory_order_acq_rel);
+            }
+            continue;
+        }
+
+        // 没有可执行的任务，准备睡眠：先登记为空闲再检查一次，避免丢失唤醒
+        uint32_t signal = _M_signal.load(std::memory_order_acquire);
+        _M_idleNr.fetch_add(1, std::memory_order_seq_cst);
+        if (_M_stop.load(std::memory_order_acquire) && !hasWork())
+        {
+            _M_idleNr.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        if (!hasWork())
+        {
+            futexWait(&_M_signal, signal);
+        }
+        _M_idleNr.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void ExecutorGroup::shutdown()
+{
+    if (_M_stop.exchange(true))
+        return;
+
+    size_t nr = _M_executorNr.load(std::memory_order_acquire);
+    for (size_t i = 0; i < nr; i++)
+    {
+        _M_executors[i]->wait();
+    }
+
+    _M_signal.fetch_add(1, std::memory_order_release);
+    futexWake(&_M_signal);
+    for (auto &worker : _M_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+
+#ifndef NDEBUG
+    printf("[INFO] ExecutorGroup: Shutted!\n");
+#endif
+}
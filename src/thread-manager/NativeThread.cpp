@@ -0,0 +1,110 @@
+#include "NativeThread.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <limits.h>
+
+#ifndef NDEBUG
+#include <stdio.h>
+#endif
+
+// 保留当前栈顶之下的一段空间，供 madvise 调用本身和信号处理使用
+constexpr uintptr_t STACK_TRIM_MARGIN = 16 * 1024;
+
+namespace
+{
+    struct Entry
+    {
+        void (*func)(void *);
+        void *arg;
+    };
+
+    void *entry(void *arg)
+    {
+        Entry call = *static_cast<Entry *>(arg);
+        delete static_cast<Entry *>(arg);
+        call.func(call.arg);
+        return nullptr;
+    }
+}
+
+NativeThread::~NativeThread()
+{
+    if (_M_joinable)
+        pthread_detach(_M_handle);
+}
+
+bool NativeThread::start(void (*func)(void *), void *arg, const ThreadAttr &attr)
+{
+    if (_M_joinable)
+        return false;
+
+    pthread_attr_t pattr;
+    pthread_attr_init(&pattr);
+    bool custom = false;
+    if (attr.stackSize)
+    {
+        size_t stackMin = PTHREAD_STACK_MIN;
+        size_t stackSize = attr.stackSize < stackMin ? stackMin : attr.stackSize;
+        custom |= pthread_attr_setstacksize(&pattr, stackSize) == 0;
+    }
+    if (attr.guardSize != STACK_GUARD_DEFAULT)
+    {
+        custom |= pthread_attr_setguardsize(&pattr, attr.guardSize) == 0;
+    }
+
+    Entry *call = new Entry{func, arg};
+    int err = pthread_create(&_M_handle, &pattr, &entry, call);
+    pthread_attr_destroy(&pattr);
+    if (err && custom)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] NativeThread: Created with custom stack failed, errno %d, retry with default!\033[0m\n", err);
+#endif
+        err = pthread_create(&_M_handle, nullptr, &entry, call);
+    }
+    if (err)
+    {
+        delete call;
+        return false;
+    }
+
+    _M_joinable = true;
+    return true;
+}
+
+void NativeThread::join()
+{
+    if (!_M_joinable)
+        return;
+    pthread_join(_M_handle, nullptr);
+    _M_joinable = false;
+}
+
+size_t trimThreadStack()
+{
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0)
+        return 0;
+
+    void *stackAddr = nullptr;
+    size_t stackSize = 0;
+    int err = pthread_attr_getstack(&attr, &stackAddr, &stackSize);
+    pthread_attr_destroy(&attr);
+    if (err)
+        return 0;
+
+    // 栈向低地址增长，当前栈顶以下的页面都没有在使用
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    char marker = 0;
+    uintptr_t top = reinterpret_cast<uintptr_t>(&marker);
+    uintptr_t low = (reinterpret_cast<uintptr_t>(stackAddr) + page - 1) & ~(page - 1);
+    if (top < low + STACK_TRIM_MARGIN || top > reinterpret_cast<uintptr_t>(stackAddr) + stackSize)
+        return 0;
+    uintptr_t high = (top - STACK_TRIM_MARGIN) & ~(page - 1);
+    if (high <= low)
+        return 0;
+
+    if (madvise(reinterpret_cast<void *>(low), high - low, MADV_DONTNEED) != 0)
+        return 0;
+    return high - low;
+}
@@ -0,0 +1,212 @@
+#include "Reactor.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifndef NDEBUG
+#include <stdio.h>
+#endif
+
+constexpr int Reactor::EVENT_BATCH;
+
+EventNotifier::EventNotifier() : _M_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+#ifndef NDEBUG
+    if (_M_fd < 0)
+        printf("\033[33m[WARNING] EventNotifier: eventfd created failed, errno %d!\033[0m\n", errno);
+#endif
+}
+
+EventNotifier::~EventNotifier()
+{
+    if (_M_fd >= 0)
+        close(_M_fd);
+}
+
+bool EventNotifier::notify(uint64_t nr)
+{
+    // 计数器即将溢出时写入会返回 EAGAIN，此时读者一定还有未处理的通知，可以忽略
+    return write(_M_fd, &nr, sizeof(nr)) == sizeof(nr) || errno == EAGAIN;
+}
+
+uint64_t EventNotifier::consume()
+{
+    uint64_t nr = 0;
+    if (read(_M_fd, &nr, sizeof(nr)) != sizeof(nr))
+        return 0;
+    return nr;
+}
+
+void Reactor::init()
+{
+    _M_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (_M_epoll < 0 || !_M_wakeup.valid())
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] Reactor: epoll created failed, errno %d!\033[0m\n", errno);
+#endif
+        return;
+    }
+
+    // 唤醒用的 eventfd 以空指针作为标记
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(_M_epoll, EPOLL_CTL_ADD, _M_wakeup.fd(), &ev);
+
+    _M_loop = std::thread(&Reactor::run, this);
+}
+
+Reactor::~Reactor()
+{
+    _M_stop.store(true, std::memory_order_release);
+    _M_wakeup.notify();
+    if (_M_loop.joinable())
+        _M_loop.join();
+
+    // 事件循环已经结束，不会再提交新的回调
+    _M_inFlight.wait();
+
+    for (auto &entry : _M_handlers)
+        delete entry.second;
+    for (Handler *handler : _M_retired)
+        release(handler);
+    if (_M_epoll >= 0)
+        close(_M_epoll);
+
+#ifndef NDEBUG
+    printf("[INFO] Reactor: Shutted!\n");
+#endif
+}
+
+bool Reactor::add(int fd, uint32_t events, Callback callback)
+{
+    if (!valid())
+        return false;
+
+    Handler *handler = new Handler();
+    handler->fd = fd;
+    handler->events = events | EPOLLONESHOT;
+    handler->ready.store(0, std::memory_order_relaxed);
+    handler->refs.store(1, std::memory_order_relaxed);
+    handler->removed.store(false, std::memory_order_relaxed);
+    handler->callback = std::move(callback);
+    handler->reactor = this;
+
+    struct epoll_event ev;
+    ev.events = handler->events;
+    ev.data.ptr = handler;
+
+    std::lock_guard<std::mutex> lock(_M_mutex);
+    if (_M_handlers.count(fd) || epoll_ctl(_M_epoll, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] Reactor: fd %d registered failed!\033[0m\n", fd);
+#endif
+        delete handler;
+        return false;
+    }
+    _M_handlers[fd] = handler;
+    return true;
+}
+
+bool Reactor::remove(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(_M_mutex);
+        auto it = _M_handlers.find(fd);
+        if (it == _M_handlers.end())
+            return false;
+
+        Handler *handler = it->second;
+        _M_handlers.erase(it);
+        epoll_ctl(_M_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        handler->removed.store(true, std::memory_order_relaxed);
+        // 事件循环可能正持有本轮 epoll_wait 返回的指针，只能由它在本轮结束后释放
+        _M_retired.push_back(handler);
+    }
+    _M_wakeup.notify();
+    return true;
+}
+
+size_t Reactor::size()
+{
+    std::lock_guard<std::mutex> lock(_M_mutex);
+    return _M_handlers.size();
+}
+
+void Reactor::release(Handler *handler)
+{
+    if (handler->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete handler;
+}
+
+void Reactor::dispatch(void *arg)
+{
+    Handler *handler = static_cast<Handler *>(arg);
+    Reactor *reactor = handler->reactor;
+
+    // 已经被移除的描述符不再执行回调，它可能已经被关闭
+    if (!handler->removed.load(std::memory_order_relaxed))
+        handler->callback(handler->fd, handler->ready.load(std::memory_order_acquire));
+
+    {
+        // 回调结束后重新监听；在锁内检查，避免描述符被关闭并复用后修改了新的注册
+        std::lock_guard<std::mutex> lock(reactor->_M_mutex);
+        if (!handler->removed.load(std::memory_order_relaxed))
+        {
+            struct epoll_event ev;
+            ev.events = handler->events;
+            ev.data.ptr = handler;
+            epoll_ctl(reactor->_M_epoll, EPOLL_CTL_MOD, handler->fd, &ev);
+        }
+    }
+
+    release(handler);
+    reactor->_M_inFlight.done();
+}
+
+void Reactor::run()
+{
+    struct epoll_event events[EVENT_BATCH];
+
+    while (!_M_stop.load(std::memory_order_acquire))
+    {
+        int nr = epoll_wait(_M_epoll, events, EVENT_BATCH, -1);
+        if (nr < 0 && errno != EINTR)
+        {
+#ifndef NDEBUG
+            printf("\033[33m[WARNING] Reactor: epoll_wait failed, errno %d!\033[0m\n", errno);
+#endif
+            break;
+        }
+
+        for (int i = 0; i < nr; i++)
+        {
+            Handler *handler = static_cast<Handler *>(events[i].data.ptr);
+            if (!handler)
+            {
+                _M_wakeup.consume();
+                continue;
+            }
+
+            handler->ready.store(events[i].events, std::memory_order_release);
+            handler->refs.fetch_add(1, std::memory_order_relaxed);
+            _M_inFlight.add();
+            // 线程池暂停时回调被推迟到恢复运行；只有线程池已经终止时，
+            // 才直接在事件循环中执行回调
+            if (!_M_post(_M_manager, Task(&Reactor::dispatch, handler)))
+                dispatch(handler);
+        }
+
+        // 本轮的事件已经处理完，可以安全地释放已经移除的注册
+        std::vector<Handler *> retired;
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            retired.swap(_M_retired);
+        }
+        for (Handler *handler : retired)
+            release(handler);
+    }
+}
@@ -0,0 +1,90 @@
+#include "ShmQueue.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifndef NDEBUG
+#include <stdio.h>
+#endif
+
+bool ShmRegion::map(int fd)
+{
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] ShmRegion: Shared memory mapped failed, errno %d!\033[0m\n", errno);
+#endif
+        close(fd);
+        return false;
+    }
+
+    _M_fd = fd;
+    _M_addr = addr;
+    _M_size = st.st_size;
+    return true;
+}
+
+bool ShmRegion::create(size_t size, const char *name)
+{
+    reset();
+
+    int fd = name ? shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600)
+                  : memfd_create("thread_pool", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] ShmRegion: Shared memory created failed, errno %d!\033[0m\n", errno);
+#endif
+        return false;
+    }
+    if (ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        if (name)
+            shm_unlink(name);
+        return false;
+    }
+    return map(fd);
+}
+
+bool ShmRegion::open(const char *name)
+{
+    reset();
+
+    int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    return map(fd);
+}
+
+bool ShmRegion::attach(int fd)
+{
+    reset();
+
+    int dupFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dupFd < 0)
+        return false;
+    return map(dupFd);
+}
+
+void ShmRegion::reset()
+{
+    if (_M_addr)
+        munmap(_M_addr, _M_size);
+    if (_M_fd >= 0)
+        close(_M_fd);
+    _M_fd = -1;
+    _M_addr = nullptr;
+    _M_size = 0;
+}
+
+bool ShmRegion::unlink(const char *name)
+{
+    return shm_unlink(name) == 0;
+}
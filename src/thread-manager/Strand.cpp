@@ -0,0 +1,48 @@
+#include <thread>
+#include "Strand.h"
+#include "Futex.h"
+
+constexpr size_t Strand::BATCH_SIZE;
+constexpr size_t Strand::STRAND_QUEUE_SIZE;
+
+bool Strand::post(Task &&task)
+{
+    while (!_M_tasks.tryPush(std::move(task)))
+    {
+        std::this_thread::yield();
+    }
+
+    // 入队先于计数，计数为正时队列中一定有已经写入或正在写入的任务
+    if (_M_pending.fetch_add(1, std::memory_order_acq_rel) == 0)
+    {
+        // 暂停时排空任务被推迟到恢复运行；只有线程池已经终止时，
+        // 才直接在当前线程中排空，保证任务不会丢失
+        if (!_M_post(_M_manager, Task(&Strand::drain, this)))
+            drain(this);
+    }
+    return true;
+}
+
+void Strand::drain(void *arg)
+{
+    Strand *strand = static_cast<Strand *>(arg);
+
+    do
+    {
+        for (size_t i = 0; i < BATCH_SIZE; i++)
+        {
+            Task task;
+            // 其他生产者可能预留了更靠前的槽位但还没有写完，稍等即可
+            while (!strand->_M_tasks.tryPop(task))
+            {
+                cpuRelax();
+            }
+            task();
+
+            if (strand->_M_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                return;
+        }
+        // 执行了一批任务后重新提交，让其他任务也有机会使用这个工作线程；
+        // 线程池已经终止时没有其他线程可用，继续在当前线程中执行
+    } while (!strand->_M_post(strand->_M_manager, Task(&Strand::drain, strand)));
+}
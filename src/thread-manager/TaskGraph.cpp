@@ -0,0 +1,149 @@
+#include "TaskGraph.h"
+
+#ifndef NDEBUG
+#include <stdio.h>
+#endif
+
+TaskGraph::NodeId TaskGraph::addNode(std::function<void()> func)
+{
+    _M_nodes.emplace_back(new Node(std::move(func), _M_nodes.size(), this));
+    _M_dirty = true;
+    return _M_nodes.size() - 1;
+}
+
+void TaskGraph::addEdge(NodeId from, NodeId to)
+{
+    if (from >= _M_nodes.size() || to >= _M_nodes.size())
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] TaskGraph: Edge %lu -> %lu refers to a missing node!\033[0m\n", from, to);
+#endif
+        return;
+    }
+    _M_nodes[from]->succ.push_back(_M_nodes[to].get());
+    _M_nodes[to]->inDegree++;
+    _M_dirty = true;
+}
+
+bool TaskGraph::prepare()
+{
+    if (!_M_dirty)
+        return _M_acyclic;
+
+    // 重新计算根节点，并用拓扑排序检查是否存在环
+    _M_roots.clear();
+    std::vector<size_t> degree(_M_nodes.size());
+    std::vector<Node *> order;
+    order.reserve(_M_nodes.size());
+    for (size_t i = 0; i < _M_nodes.size(); i++)
+    {
+        degree[i] = _M_nodes[i]->inDegree;
+        if (!degree[i])
+        {
+            _M_roots.push_back(_M_nodes[i].get());
+            order.push_back(_M_nodes[i].get());
+        }
+    }
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        for (Node *succ : order[i]->succ)
+        {
+            if (!--degree[succ->id])
+                order.push_back(succ);
+        }
+    }
+
+    _M_acyclic = order.size() == _M_nodes.size();
+    _M_dirty = false;
+#ifndef NDEBUG
+    if (!_M_acyclic)
+        printf("\033[33m[WARNING] TaskGraph: The graph contains a cycle and can not run!\033[0m\n");
+#endif
+    return _M_acyclic;
+}
+
+void TaskGraph::dispatch(Node *node)
+{
+    // 线程池暂停时节点被推迟到恢复运行；只有线程池已经终止时，
+    // 才直接在当前线程中执行，保证本次执行能够结束
+    if (!_M_post(_M_manager, Task(&TaskGraph::execute, node)))
+    {
+        execute(node);
+    }
+}
+
+void TaskGraph::execute(void *arg)
+{
+    Node *node = static_cast<Node *>(arg);
+    TaskGraph *graph = node->graph;
+
+    while (node)
+    {
+        try
+        {
+            node->func();
+        }
+        catch (...)
+        {
+            if (!graph->_M_failed.test_and_set())
+                graph->_M_error = std::current_exception();
+        }
+
+        // 第一个就绪的后继由当前线程接着执行，其余的提交给线程池
+        Node *next = nullptr;
+        for (Node *succ : node->succ)
+        {
+            if (succ->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if (!next)
+                    next = succ;
+                else
+                    graph->dispatch(succ);
+            }
+        }
+
+        graph->_M_remaining.done();
+        node = next;
+    }
+}
+
+bool TaskGraph::launch(void *manager, bool (*start)(void *, Task &&), bool (*post)(void *, Task &&))
+{
+    if (!prepare())
+        return false;
+    if (_M_nodes.empty())
+        return true;
+
+    _M_manager = manager;
+    _M_post = post;
+    _M_error = nullptr;
+    _M_failed.clear();
+    for (auto &node : _M_nodes)
+    {
+        node->pending.store(node->inDegree, std::memory_order_relaxed);
+    }
+    _M_remaining.add(_M_nodes.size());
+
+    // 第一个根节点提交失败说明线程池不在运行状态，直接放弃本次执行；
+    // 之后的根节点与执行中就绪的节点一样，在线程池暂停时被推迟
+    if (!start(manager, Task(&TaskGraph::execute, _M_roots[0])))
+    {
+        _M_remaining.done(_M_nodes.size());
+        _M_manager = nullptr;
+        _M_post = nullptr;
+        return false;
+    }
+    for (size_t i = 1; i < _M_roots.size(); i++)
+    {
+        dispatch(_M_roots[i]);
+    }
+
+    _M_remaining.wait();
+    _M_manager = nullptr;
+    _M_post = nullptr;
+
+    if (_M_error)
+        std::rethrow_exception(_M_error);
+    return true;
+}
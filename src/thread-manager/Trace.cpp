@@ -0,0 +1,197 @@
+#include "Trace.h"
+#include <sys/resource.h>
+#include <stdio.h>
+
+constexpr uint32_t TRACE_MAGIC = 0x52545054; // "TPTR"
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr uint64_t BUSY_CALIBRATE_ITERATIONS = 1 << 22;
+
+namespace
+{
+    // 文件头，之后是 count 个按提交时刻排序的 TraceRecord
+    struct TraceHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t count;
+        uint64_t dropped;
+    };
+
+    std::atomic<uint32_t> nextThreadId(0);
+}
+
+uint32_t traceThreadId()
+{
+    static thread_local uint32_t id = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+/* ------------------------------ TraceRecorder ------------------------------ */
+
+TraceRecorder::TraceRecorder(size_t capacity)
+    : _M_records(capacity), _M_size(0), _M_dropped(0),
+      _M_origin(std::chrono::steady_clock::now()) {}
+
+void TraceRecorder::record(uint64_t submit, uint64_t duration, uint32_t thread)
+{
+    size_t index = _M_size.fetch_add(1, std::memory_order_relaxed);
+    if (index >= _M_records.size())
+    {
+        _M_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TraceRecord &rec = _M_records[index];
+    rec.submit = submit;
+    rec.duration = duration > UINT32_MAX ? UINT32_MAX : (uint32_t)duration;
+    rec.thread = thread;
+}
+
+void TraceRecorder::Entry::operator()()
+{
+    uint64_t start = recorder->now();
+    task();
+    recorder->record(submit, recorder->now() - start, thread);
+}
+
+Task TraceRecorder::wrap(Task &&task)
+{
+    return Task(Entry{this, std::move(task), now(), traceThreadId()});
+}
+
+std::vector<TraceRecord> TraceRecorder::records() const
+{
+    std::vector<TraceRecord> records(_M_records.begin(), _M_records.begin() + size());
+    std::sort(records.begin(), records.end(), [](const TraceRecord &a, const TraceRecord &b)
+              { return a.submit < b.submit; });
+    return records;
+}
+
+bool TraceRecorder::save(const char *path) const
+{
+    std::vector<TraceRecord> records = this->records();
+    TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, records.size(), dropped()};
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] TraceRecorder: Trace file '%s' opened failed!\033[0m\n", path);
+#endif
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(records.data(), sizeof(TraceRecord), records.size(), file) == records.size();
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+bool loadTrace(const char *path, std::vector<TraceRecord> &records)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    TraceHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == TRACE_MAGIC && header.version == TRACE_VERSION;
+    if (ok)
+    {
+        records.resize(header.count);
+        ok = fread(records.data(), sizeof(TraceRecord), records.size(), file) == records.size();
+    }
+    fclose(file);
+    if (!ok)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] TraceRecorder: Trace file '%s' is truncated or invalid!\033[0m\n", path);
+#endif
+        records.clear();
+    }
+    return ok;
+}
+
+/* -------------------------------- BusyWork -------------------------------- */
+
+BusyWork::BusyWork() : _M_perNs(0)
+{
+    // 取多次测量中最快的一次，减少被调度打断的影响
+    for (int i = 0; i < 3; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        spin(BUSY_CALIBRATE_ITERATIONS);
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+        double perNs = (double)BUSY_CALIBRATE_ITERATIONS / (ns ? ns : 1);
+        if (perNs > _M_perNs)
+            _M_perNs = perNs;
+    }
+}
+
+void BusyWork::run(uint64_t ns) const
+{
+    spin((uint64_t)(ns * _M_perNs));
+}
+
+uint64_t BusyWork::spin(uint64_t iterations)
+{
+    // xorshift 的每一步依赖上一步的结果，编译器无法合并或省略
+    volatile uint64_t sink;
+    uint64_t x = 88172645463325252ull;
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    sink = x;
+    return sink;
+}
+
+/* --------------------------------- Replay --------------------------------- */
+
+double processCpuSeconds()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+namespace detail
+{
+    void replayOne(void *arg)
+    {
+        ReplaySlot *slot = static_cast<ReplaySlot *>(arg);
+        slot->delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - slot->submitted)
+                          .count();
+        slot->executed = true;
+        slot->work->run(slot->record->duration);
+        slot->done->done();
+    }
+
+    void summarize(std::vector<ReplaySlot> &slots, ReplayReport &report)
+    {
+        report.throughput = report.seconds > 0 ? (report.tasks - report.dropped) / report.seconds : 0;
+
+        std::vector<uint64_t> delays;
+        delays.reserve(slots.size());
+        for (auto &slot : slots)
+        {
+            if (slot.executed)
+                delays.push_back(slot.delay);
+        }
+        if (delays.empty())
+            return;
+
+        std::sort(delays.begin(), delays.end());
+        auto at = [&](double ratio)
+        { return delays[(size_t)(ratio * (delays.size() - 1))]; };
+        report.delayP50 = at(0.5);
+        report.delayP90 = at(0.9);
+        report.delayP99 = at(0.99);
+        report.delayMax = delays.back();
+    }
+}
@@ -0,0 +1,87 @@
+#include "WorkerLocal.h"
+#include <cstdlib>
+
+#ifndef NDEBUG
+#include <stdio.h>
+#endif
+
+constexpr size_t Arena::HEADER_SIZE;
+
+Arena::~Arena()
+{
+    release();
+}
+
+void *Arena::allocateSlow(size_t size, size_t align)
+{
+    // 先尝试 reset 之前已经申请过的后续块
+    Block *block = _M_current ? _M_current->next : _M_head;
+    for (; block; block = block->next)
+    {
+        _M_current = block;
+        _M_ptr = data(block);
+        _M_end = _M_ptr + block->size;
+
+        uintptr_t ptr = (reinterpret_cast<uintptr_t>(_M_ptr) + align - 1) & ~(uintptr_t)(align - 1);
+        if (ptr + size <= reinterpret_cast<uintptr_t>(_M_end))
+        {
+            _M_ptr = reinterpret_cast<char *>(ptr + size);
+            return reinterpret_cast<void *>(ptr);
+        }
+    }
+
+    // 超过块大小的分配单独使用一个块
+    size_t blockSize = size + align > _M_blockSize ? size + align : _M_blockSize;
+    block = static_cast<Block *>(malloc(HEADER_SIZE + blockSize));
+    if (!block)
+    {
+#ifndef NDEBUG
+        printf("\033[33m[WARNING] Arena: Block of %lu bytes allocated failed!\033[0m\n", blockSize);
+#endif
+        return nullptr;
+    }
+    block->size = blockSize;
+    if (_M_current)
+    {
+        block->next = _M_current->next;
+        _M_current->next = block;
+    }
+    else
+    {
+        block->next = nullptr;
+        _M_head = block;
+    }
+
+    _M_current = block;
+    _M_ptr = data(block);
+    _M_end = _M_ptr + blockSize;
+    uintptr_t ptr = (reinterpret_cast<uintptr_t>(_M_ptr) + align - 1) & ~(uintptr_t)(align - 1);
+    _M_ptr = reinterpret_cast<char *>(ptr + size);
+    return reinterpret_cast<void *>(ptr);
+}
+
+void Arena::release()
+{
+    while (_M_head)
+    {
+        Block *next = _M_head->next;
+        free(_M_head);
+        _M_head = next;
+    }
+    _M_current = nullptr;
+    _M_ptr = _M_end = nullptr;
+}
+
+size_t Arena::capacity() const
+{
+    size_t total = 0;
+    for (Block *block = _M_head; block; block = block->next)
+        total += block->size;
+    return total;
+}
+
+size_t nextWorkerLocalId()
+{
+    static std::atomic<size_t> id(0);
+    return id.fetch_add(1, std::memory_order_relaxed);
+}
@@ -23,7 +23,7 @@ int main()
     {
         auto startTime = chrono::system_clock::now();
 
-        std::future<void> ret = mngr.submit(printText);
+        Future<void> ret = mngr.submit(printText);
 
         auto endTime = chrono::system_clock::now();
         auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
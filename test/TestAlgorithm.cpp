@@ -0,0 +1,165 @@
+#include "Thread.h"
+#include "Algorithm.h"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <cstdlib>
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double msSince(Clock::time_point start)
+{
+    return chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+void report(const char *name, size_t n, double serial, double parallel)
+{
+    cout << "[INFO] TestAlgorithm: " << name << " n=" << n << " std " << serial
+         << " ms, parallel " << parallel << " ms." << endl;
+}
+
+// 对比并行算法与 std:: 串行版本的结果和耗时，返回失败的数量
+int compare(ThreadManager &mngr, size_t n)
+{
+    int failed = 0;
+    mt19937_64 gen(n);
+    vector<long long> data(n);
+    for (auto &x : data)
+        x = gen() % 1000000;
+
+    // for_each
+    {
+        vector<long long> a(data), b(data);
+        auto start = Clock::now();
+        for_each(a.begin(), a.end(), [](long long &x)
+                 { x = x * 3 + 1; });
+        double serial = msSince(start);
+        start = Clock::now();
+        parallelForEach(mngr, b.begin(), b.end(), [](long long &x)
+                        { x = x * 3 + 1; });
+        report("for_each", n, serial, msSince(start));
+        failed += a != b;
+    }
+
+    // transform_reduce
+    {
+        auto square = [](long long x)
+        { return x * x; };
+        auto start = Clock::now();
+        long long expect = 0;
+        for (long long x : data)
+            expect += square(x);
+        double serial = msSince(start);
+        start = Clock::now();
+        long long actual = parallelTransformReduce(mngr, data.begin(), data.end(), 0LL,
+                                                   plus<long long>(), square);
+        report("transform_reduce", n, serial, msSince(start));
+        failed += expect != actual;
+        failed += parallelReduce(mngr, data.begin(), data.end(), 0LL) !=
+                  accumulate(data.begin(), data.end(), 0LL);
+    }
+
+    // scan
+    {
+        vector<long long> a(n), b(n);
+        auto start = Clock::now();
+        partial_sum(data.begin(), data.end(), a.begin());
+        double serial = msSince(start);
+        start = Clock::now();
+        parallelInclusiveScan(mngr, data.begin(), data.end(), b.begin());
+        report("inclusive_scan", n, serial, msSince(start));
+        failed += a != b;
+
+        // 原地的前缀和
+        vector<long long> c(data);
+        parallelExclusiveScan(mngr, c.begin(), c.end(), c.begin(), 5LL);
+        for (size_t i = 0; i < n; i++)
+            failed += c[i] != (i ? a[i - 1] : 0) + 5;
+    }
+
+    // copy_if / partition
+    {
+        auto odd = [](long long x)
+        { return x & 1; };
+        vector<long long> a(n), b(n);
+        auto start = Clock::now();
+        auto aEnd = copy_if(data.begin(), data.end(), a.begin(), odd);
+        double serial = msSince(start);
+        start = Clock::now();
+        auto bEnd = parallelCopyIf(mngr, data.begin(), data.end(), b.begin(), odd);
+        report("copy_if", n, serial, msSince(start));
+        failed += (aEnd - a.begin()) != (bEnd - b.begin()) || !equal(a.begin(), aEnd, b.begin());
+
+        vector<long long> c(data), d(data);
+        start = Clock::now();
+        auto cPoint = stable_partition(c.begin(), c.end(), odd);
+        serial = msSince(start);
+        start = Clock::now();
+        auto dPoint = parallelPartition(mngr, d.begin(), d.end(), odd);
+        report("partition", n, serial, msSince(start));
+        failed += (cPoint - c.begin()) != (dPoint - d.begin()) || c != d;
+    }
+
+    // sort，使用只比较高位的比较器同时检查稳定性
+    {
+        vector<long long> a(data), b(data);
+        auto byHigh = [](long long x, long long y)
+        { return x / 1000 < y / 1000; };
+        auto start = Clock::now();
+        stable_sort(a.begin(), a.end(), byHigh);
+        double serial = msSince(start);
+        start = Clock::now();
+        parallelSort(mngr, b.begin(), b.end(), byHigh);
+        report("sort", n, serial, msSince(start));
+        failed += a != b;
+    }
+
+    return failed;
+}
+
+// 参数为最大规模的指数，默认到 1e6，基准测试时可以指定到 8
+int main(int argc, char *argv[])
+{
+    int maxExp = argc > 1 ? atoi(argv[1]) : 6;
+    int failed = 0;
+
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 规模不足一块、刚好跨越块边界的情况
+    for (size_t n : {(size_t)0, (size_t)1, ALGO_GRAIN_MIN - 1, ALGO_GRAIN_MIN + 1, (size_t)50000})
+    {
+        vector<int> v(n);
+        for (size_t i = 0; i < n; i++)
+            v[i] = (int)((i * 7919) % 1013);
+        vector<int> s(v);
+        sort(s.begin(), s.end());
+        parallelSort(mngr, v.begin(), v.end());
+        failed += v != s;
+    }
+
+    // 异常在调用线程中重新抛出
+    try
+    {
+        vector<int> v(100000);
+        parallelForEach(mngr, v.begin(), v.end(), [](int &)
+                        { throw runtime_error("expected"); });
+        failed++;
+    }
+    catch (const runtime_error &)
+    {
+    }
+
+    for (int e = 5; e <= maxExp; e++)
+    {
+        size_t n = 1;
+        for (int i = 0; i < e; i++)
+            n *= 10;
+        failed += compare(mngr, n);
+    }
+
+    mngr.shutdown();
+    return failed;
+}
@@ -0,0 +1,60 @@
+#include "Thread.h"
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int blockerNr = 2;
+constexpr int turn = 1000;
+
+atomic_int cnt;
+atomic_int seenByBlocker;
+
+int main()
+{
+    ThreadManager mngr(blockerNr);
+    mngr.start();
+
+    // 所有工作线程都被阻塞的任务占据，依靠补偿线程执行后续的任务
+    Future<void> blockers[blockerNr];
+    for (int i = 0; i < blockerNr; i++)
+    {
+        blockers[i] = mngr.submit([&mngr]
+                                  {
+            mngr.blocking([]
+                          { this_thread::sleep_for(chrono::milliseconds(200)); });
+            seenByBlocker += cnt.load(); });
+    }
+
+    auto startTime = chrono::steady_clock::now();
+    Future<void> last;
+    for (int i = 0; i < turn; i++)
+    {
+        last = mngr.submit([]
+                           { cnt++; });
+    }
+    last.get();
+    auto endTime = chrono::steady_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+
+    for (int i = 0; i < blockerNr; i++)
+    {
+        blockers[i].get();
+    }
+
+    // 阻塞区间结束后补偿线程退役
+    if (mngr.blockedNr() != 0)
+        return 1;
+
+    // 在非工作线程中调用时直接执行
+    if (mngr.blocking([]
+                      { return 7; }) != 7)
+        return 1;
+
+    mngr.shutdown();
+
+    cout << "[INFO] TestBlocking: " << turn << " tasks finished in " << duration.count()
+         << " us while all workers were blocked." << endl;
+
+    // 阻塞的任务醒来时，其余任务应该已经全部完成
+    return seenByBlocker.load() - blockerNr * turn;
+}
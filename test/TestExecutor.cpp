@@ -0,0 +1,75 @@
+#include "Executor.h"
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 20000;
+
+atomic_int cpuCnt, ioCnt, bgCnt;
+atomic_int bgRunning, bgPeak;
+
+void cpuTask()
+{
+    cpuCnt++;
+}
+
+void ioTask()
+{
+    ioCnt++;
+}
+
+void bgTask()
+{
+    int running = ++bgRunning;
+    int peak = bgPeak.load();
+    while (running > peak && !bgPeak.compare_exchange_weak(peak, running))
+    {
+    }
+    bgCnt++;
+    bgRunning--;
+}
+
+int main()
+{
+    ExecutorGroup group(4);
+    // 计算任务权重更高，I/O 回调保证至少一个线程，后台任务最多占用一个线程
+    Executor *cpu = group.create(4);
+    Executor *io = group.create(1, 1);
+    Executor *bg = group.create(1, 0, 1);
+    if (!cpu || !io || !bg)
+        return 1;
+
+    auto startTime = chrono::steady_clock::now();
+    for (int i = 0; i < turn; i++)
+    {
+        cpu->post(Task([](void *)
+                       { cpuTask(); },
+                       nullptr));
+        io->submit(ioTask);
+        bg->submit(bgTask);
+    }
+
+    Future<int> ret = cpu->submit([]
+                                  { return 42; });
+    if (ret.get() != 42)
+        return 1;
+
+    cpu->wait();
+    io->wait();
+    bg->wait();
+    auto endTime = chrono::steady_clock::now();
+    group.shutdown();
+
+    // 关闭后提交的任务会被拒绝
+    if (cpu->post(Task([](void *) {}, nullptr)))
+        return 1;
+
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+    cout << "[INFO] TestExecutor: " << group.workerNr() << " worker(s) ran "
+         << 3 * turn << " tasks in " << duration.count() << " us, background peak "
+         << bgPeak.load() << "." << endl;
+
+    if (bgPeak.load() > 1)
+        return 1;
+    return (cpuCnt.load() - turn) | (ioCnt.load() - turn) | (bgCnt.load() - turn);
+}
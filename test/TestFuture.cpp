@@ -0,0 +1,133 @@
+#include "Thread.h"
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <set>
+using namespace std;
+
+constexpr int turn = 100000;
+
+int square(int a)
+{
+    return a * a;
+}
+
+int counter = 0;
+
+int &counterRef()
+{
+    return counter;
+}
+
+int fail()
+{
+    throw runtime_error("expected");
+}
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 1. 提交并等待结果，统计每个任务往返的平均耗时
+    long long costTime = 0LL;
+    long long sum = 0LL;
+    for (int i = 0; i < turn; i++)
+    {
+        auto startTime = chrono::steady_clock::now();
+
+        Future<int> ret = mngr.submit(square, i % 100);
+        sum += ret.get();
+
+        auto endTime = chrono::steady_clock::now();
+        costTime += chrono::duration_cast<chrono::nanoseconds>(endTime - startTime).count();
+    }
+
+    long long expect = 0LL;
+    for (int i = 0; i < turn; i++)
+    {
+        expect += (i % 100) * (i % 100);
+    }
+    if (sum != expect)
+        return 1;
+
+    // 2. 任务中的异常通过 get() 重新抛出
+    Future<int> err = mngr.submit(fail);
+    try
+    {
+        err.get();
+        return 1;
+    }
+    catch (const runtime_error &)
+    {
+    }
+    if (err.valid())
+        return 1;
+
+    // 3. 限时等待
+    Future<void> slow = mngr.submit([]
+                                    { this_thread::sleep_for(chrono::milliseconds(50)); });
+    if (slow.waitFor(chrono::milliseconds(1)))
+        return 1;
+    slow.get();
+
+    // 4. Promise 在写入结果前销毁，Future 得到 broken_promise
+    Future<int> broken;
+    {
+        Promise<int> promise;
+        broken = promise.getFuture();
+    }
+    try
+    {
+        broken.get();
+        return 1;
+    }
+    catch (const future_error &e)
+    {
+        if (e.code() != future_errc::broken_promise)
+            return 1;
+    }
+
+    // 5. 返回引用的任务，get() 得到的是同一个对象
+    Future<int &> ref = mngr.submit(counterRef);
+    int &got = ref.get();
+    got = 42;
+    if (&got != &counter || counter != 42)
+        return 1;
+
+    mngr.shutdown();
+
+    // 6. 在其他线程中释放的共享状态回到分配线程，再次分配时复用
+    {
+        using Pool = StatePool<64>;
+        vector<void *> blocks;
+        for (int i = 0; i < 100; i++)
+            blocks.push_back(Pool::allocate());
+        set<void *> first(blocks.begin(), blocks.end());
+        thread([&]
+               { for (void *block : blocks) Pool::deallocate(block); })
+            .join();
+        for (int i = 0; i < 100; i++)
+        {
+            blocks[i] = Pool::allocate();
+            if (!first.count(blocks[i]))
+                return 1;
+        }
+        for (void *block : blocks)
+            Pool::deallocate(block);
+        Pool::trim();
+
+        // 分配线程退出之后才释放，内存块直接归还给系统
+        thread([&]
+               { for (int i = 0; i < 100; i++) blocks[i] = Pool::allocate(); })
+            .join();
+        for (void *block : blocks)
+            Pool::deallocate(block);
+    }
+
+    cout << "[INFO] TestFuture: Spent " << ((double)costTime / turn) << " ns/round trip." << endl;
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "Thread.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+using ParkManager = BasicThreadManager<LockFreeQueue<Task>, ParkWait, CountingStats>;
+
+constexpr int turn = 20000;
+constexpr int rounds = 2000;
+
+/* 请求-应答：每次提交一个任务并等待结果，返回从提交到开始执行的中位数延迟 */
+template <typename _Manager>
+long long dispatchLatency(_Manager &mngr)
+{
+    vector<long long> delays;
+    delays.reserve(rounds);
+    for (int i = 0; i < rounds; i++)
+    {
+        auto submitted = chrono::steady_clock::now();
+        auto res = mngr.submit([submitted]
+                               { return chrono::duration_cast<chrono::nanoseconds>(
+                                            chrono::steady_clock::now() - submitted)
+                                     .count(); });
+        delays.push_back(res.get());
+        // 留出时间让工作线程进入睡眠，模拟突发的低并发请求
+        if (i % 16 == 0)
+            this_thread::sleep_for(chrono::microseconds(200));
+    }
+    sort(delays.begin(), delays.end());
+    return delays[delays.size() / 2];
+}
+
+int main()
+{
+    // 1. 多个线程并发提交，每个任务恰好执行一次
+    {
+        ParkManager mngr(4);
+        mngr.start();
+        atomic<int> cnt(0);
+        auto producer = [&]
+        {
+            for (int i = 0; i < turn; i++)
+            {
+                mngr.post(Task([](void *arg)
+                               { (*static_cast<atomic<int> *>(arg))++; },
+                               &cnt));
+                if (i % 1000 == 0)
+                    this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        };
+        thread first(producer), second(producer);
+        first.join();
+        second.join();
+        mngr.shutdown();
+        if (cnt.load() != 2 * turn || mngr.stats().submitted() != mngr.stats().executed())
+        {
+            cout << "[ERROR] TestHandoff: Executed " << cnt.load() << " of " << 2 * turn << " tasks." << endl;
+            return 1;
+        }
+    }
+
+    // 2. 睡眠中的线程被交付的任务和暂停、恢复、收件箱唤醒
+    {
+        ParkManager mngr(4);
+        mngr.start();
+        this_thread::sleep_for(chrono::milliseconds(20));
+        if (mngr.submit([]
+                        { return 1; })
+                .get() != 1)
+            return 1;
+
+        this_thread::sleep_for(chrono::milliseconds(20));
+        if (mngr.submitTo(1, [&]
+                          { return mngr.workerIndex(); })
+                .get() != 1)
+            return 1;
+
+        mngr.pause();
+        mngr.resume();
+        this_thread::sleep_for(chrono::milliseconds(20));
+        auto res = mngr.trySubmit([]
+                                  { return 2; });
+        if (!res.valid() || res.get() != 2)
+            return 1;
+        mngr.shutdown();
+    }
+
+    // 3. 低并发时直接交付与经过共享队列的派发延迟
+    PoolOptions direct, queued;
+    queued.handoff = false;
+    long long latency[2];
+    PoolOptions *options[2] = {&direct, &queued};
+    for (int i = 0; i < 2; i++)
+    {
+        ParkManager mngr(4, 1000, *options[i]);
+        mngr.start();
+        latency[i] = dispatchLatency(mngr);
+        mngr.shutdown();
+    }
+
+    cout << "[INFO] TestHandoff: Median dispatch latency " << latency[0] << " ns with handoff, "
+         << latency[1] << " ns through the queue." << endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "Thread.h"
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 10000;
+
+atomic_int cnt;
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 同一个收件箱中的任务只由同一个线程按提交顺序执行
+    thread::id owner;
+    int last = -1;
+    bool ordered = true;
+    Future<void> ret;
+    for (int i = 0; i < turn; i++)
+    {
+        ret = mngr.submitTo(1, [&, i]
+                            {
+            if (last == -1)
+                owner = this_thread::get_id();
+            else if (owner != this_thread::get_id() || last != i - 1)
+                ordered = false;
+            last = i;
+            cnt++; });
+    }
+    ret.get();
+
+    // shutdown 需要等待所有收件箱排空
+    for (int i = 0; i < turn; i++)
+    {
+        mngr.submitTo(i, []
+                      { cnt++; });
+    }
+    mngr.shutdown();
+
+    if (!ordered)
+        return 1;
+
+    // 线程被收缩暂停时，收件箱中已经提交的任务仍然由它执行完再睡眠
+    {
+        LockFreeQueue<Task> queue(16);
+        MpscQueue<Task> inbox(16);
+        atomic_bool ran(false);
+        Thread thread;
+        thread.setInbox(&inbox);
+        thread.setQue(&queue);
+        thread.start();
+        inbox.tryPush(Task([](void *arg)
+                           { *static_cast<atomic_bool *>(arg) = true; },
+                           &ran));
+        thread.pause();
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(2);
+        while (!ran && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        thread.shutdown();
+        if (!ran)
+        {
+            cout << "[ERROR] TestInbox: task stranded in a paused worker's inbox." << endl;
+            return 1;
+        }
+    }
+    return cnt.load() - 2 * turn;
+}
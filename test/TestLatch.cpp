@@ -0,0 +1,62 @@
+#include "Thread.h"
+#include "Latch.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 20000;
+constexpr int taskNr = 4;
+
+void finish(void *arg)
+{
+    static_cast<Latch *>(arg)->done();
+}
+
+int main()
+{
+    auto startTime = chrono::steady_clock::now();
+
+    // 1. wait() 返回后立即销毁 Latch，done() 不能再访问它（使用 ASan 构建时可以检出）
+    {
+        ThreadManager mngr(4);
+        mngr.start();
+        for (int i = 0; i < turn; i++)
+        {
+            Latch *latch = new Latch(taskNr);
+            for (int j = 0; j < taskNr; j++)
+                mngr.post(Task(&finish, latch));
+            latch->wait();
+            delete latch;
+        }
+        mngr.shutdown();
+    }
+
+    // 2. 等待者先看到计数归零（不进入等待）再调用 wait()，同样可以立即销毁
+    for (int i = 0; i < turn / 10; i++)
+    {
+        Latch *latch = new Latch(1);
+        thread worker(finish, latch);
+        while (latch->count())
+            this_thread::yield();
+        latch->wait();
+        delete latch;
+        worker.join();
+    }
+
+    // 3. 计数归零之后还可以继续使用，限时等待在超时后返回 false
+    {
+        Latch latch;
+        latch.add(2);
+        if (latch.waitFor(chrono::milliseconds(1)))
+            return 1;
+        latch.done(2);
+        if (!latch.waitFor(chrono::milliseconds(1)) || latch.count())
+            return 1;
+    }
+
+    auto endTime = chrono::steady_clock::now();
+    auto duration = chrono::duration_cast<chrono::milliseconds>(endTime - startTime);
+    cout << "[INFO] TestLatch: Spent " << duration.count() << " ms." << endl;
+    return 0;
+}
@@ -25,7 +25,7 @@ int main()
     {
         auto startTime = chrono::system_clock::now();
 
-        std::future<void> ret = mngr.submit(printNr, i);
+        Future<void> ret = mngr.submit(printNr, i);
 
         auto endTime = chrono::system_clock::now();
         auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
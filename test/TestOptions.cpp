@@ -0,0 +1,162 @@
+#include "Thread.h"
+#include <pthread.h>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <chrono>
+#include <atomic>
+using namespace std;
+
+constexpr int turn = 200;
+
+/* 当前线程的栈大小 */
+size_t stackSize()
+{
+    pthread_attr_t attr;
+    size_t size = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0)
+    {
+        pthread_attr_getstacksize(&attr, &size);
+        pthread_attr_destroy(&attr);
+    }
+    return size;
+}
+
+int main()
+{
+    auto startTime = chrono::steady_clock::now();
+
+    // 1. 指定栈大小，不要保护页
+    {
+        PoolOptions options;
+        options.stackSize = 256 * 1024;
+        options.guardSize = 0;
+        ThreadManager mngr(4, 1000, options);
+        mngr.start();
+        auto res = mngr.submit(stackSize);
+        size_t size = res.get();
+        mngr.shutdown();
+        if (size < options.stackSize || size >= 1024 * 1024)
+        {
+            cout << "[ERROR] TestOptions: Worker stack is " << size << " bytes." << endl;
+            return 1;
+        }
+    }
+
+    // 2. 不合法的栈大小退回到默认值，任务照常执行
+    {
+        PoolOptions options;
+        options.stackSize = SIZE_MAX / 2;
+        ThreadManager mngr(2, 1000, options);
+        mngr.start();
+        auto res = mngr.submit(stackSize);
+        if (res.get() == 0)
+            return 1;
+        mngr.shutdown();
+    }
+
+    // 3. 队列为空时归还槽位的内存，之后仍然可以正常读写
+    {
+        LockFreeQueue<size_t> que(100000);
+        size_t elems[64];
+        for (size_t i = 0; i < 64; i++)
+            elems[i] = i;
+        if (que.push(elems, 64) != 64 || que.trim() != 0)
+            return 1;
+        if (que.pop(elems, 64) != 64 || que.trim() == 0)
+            return 1;
+        if (que.push(elems, 64) != 64 || que.pop(elems, 64) != 64 || elems[63] != 63)
+            return 1;
+    }
+
+    // 4. 空闲一段时间后，工作线程归还 Arena 和缓存的共享状态，下一批任务重新分配
+    {
+        PoolOptions options;
+        options.idleTrim = chrono::milliseconds(20);
+        ThreadManager mngr(4, 1000, options);
+        mngr.start();
+
+        mutex lock;
+        set<Arena *> arenas;
+        atomic<bool> cached(false);
+        auto burst = [&]
+        {
+            Future<void> res[turn];
+            for (int i = 0; i < turn; i++)
+            {
+                res[i] = mngr.submit([&]
+                                     {
+                    Arena &arena = mngr.workerArena();
+                    arena.allocate(256 * 1024);
+                    // 在工作线程中创建并丢弃的共享状态缓存在它的空闲链表中
+                    { Promise<int> promise; }
+                    if (StateCache::cachedAll())
+                        cached = true;
+                    lock_guard<mutex> guard(lock);
+                    arenas.insert(&arena); });
+            }
+            for (int i = 0; i < turn; i++)
+                res[i].get();
+        };
+
+        burst();
+        size_t capacity = 0;
+        for (Arena *arena : arenas)
+            capacity += arena->capacity();
+        if (!capacity || !cached)
+            return 1;
+
+        this_thread::sleep_for(chrono::milliseconds(200));
+        capacity = 0;
+        for (Arena *arena : arenas)
+            capacity += arena->capacity();
+        if (capacity)
+        {
+            cout << "[ERROR] TestOptions: " << capacity << " bytes still held after idle." << endl;
+            return 1;
+        }
+        // 探测任务的共享状态由提交线程分配，不会进入工作线程的缓存
+        for (size_t i = 0; i < 4; i++)
+        {
+            size_t states = mngr.submitTo(i, []
+                                          { return StateCache::cachedAll(); })
+                                .get();
+            if (states)
+            {
+                cout << "[ERROR] TestOptions: worker " << i << " still caches "
+                     << states << " states after idle." << endl;
+                return 1;
+            }
+        }
+
+        burst();
+        mngr.shutdown();
+    }
+
+    // 5. NullLock 不能排除并发的提交，管理线程不会在空闲时回收
+    {
+        PoolOptions options;
+        options.idleTrim = chrono::milliseconds(20);
+        BasicThreadManager<LockFreeQueue<Task>, YieldWait, NoStats, NullLock> mngr(2, 1000, options);
+        mngr.start();
+
+        Arena *arena = nullptr;
+        mngr.submit([&]
+                    {
+            arena = &mngr.workerArena();
+            arena->allocate(256 * 1024); })
+            .get();
+        this_thread::sleep_for(chrono::milliseconds(200));
+        if (!arena->capacity())
+        {
+            cout << "[ERROR] TestOptions: Idle trim ran with NullLock." << endl;
+            return 1;
+        }
+        mngr.shutdown();
+    }
+
+    auto endTime = chrono::steady_clock::now();
+    auto duration = chrono::duration_cast<chrono::milliseconds>(endTime - startTime);
+    cout << "[INFO] TestOptions: Spent " << duration.count() << " ms." << endl;
+    return 0;
+}
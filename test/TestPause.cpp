@@ -0,0 +1,103 @@
+#include "Thread.h"
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 400;
+constexpr int cycle = 100000;
+
+atomic_int cnt;
+
+void sleepTask()
+{
+    this_thread::sleep_for(chrono::microseconds(200));
+    cnt++;
+}
+
+int main()
+{
+    // 1. 暂停期间不会开始新的任务，恢复后剩余任务全部完成
+    {
+        ThreadManager mngr(4);
+        mngr.start();
+        for (int i = 0; i < turn; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+
+        mngr.pause();
+        // 等待已经开始的任务结束
+        this_thread::sleep_for(chrono::milliseconds(20));
+        int paused = cnt.load();
+        this_thread::sleep_for(chrono::milliseconds(50));
+        if (cnt.load() != paused)
+        {
+            cout << "[ERROR] TestPause: " << cnt.load() - paused << " task(s) ran while paused." << endl;
+            return 1;
+        }
+
+        mngr.resume();
+        mngr.shutdown();
+        if (cnt.load() != turn)
+        {
+            cout << "[ERROR] TestPause: " << cnt.load() << " of " << turn << " tasks finished." << endl;
+            return 1;
+        }
+    }
+
+    // 2. 高频率暂停/恢复，任务仍然全部完成
+    {
+        cnt = 0;
+        ThreadManager mngr(4, 2 * turn);
+        mngr.start();
+        for (int i = 0; i < turn; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+
+        auto startTime = chrono::steady_clock::now();
+        for (int i = 0; i < cycle; i++)
+        {
+            mngr.pause();
+            mngr.resume();
+        }
+        auto endTime = chrono::steady_clock::now();
+        auto duration = chrono::duration_cast<chrono::nanoseconds>(endTime - startTime);
+        cout << "[INFO] TestPause: " << duration.count() / cycle << " ns per pause/resume." << endl;
+
+        mngr.shutdown();
+        if (cnt.load() != turn)
+        {
+            return 1;
+        }
+    }
+
+    // 3. 暂停状态下直接关闭或析构，不会挂起
+    {
+        cnt = 0;
+        ThreadManager mngr(2);
+        mngr.start();
+        for (int i = 0; i < 20; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+        mngr.pause();
+        mngr.forceShutdown();
+    }
+    {
+        cnt = 0;
+        ThreadManager mngr(2);
+        mngr.start();
+        for (int i = 0; i < 20; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+        mngr.pause();
+    }
+    if (cnt.load() != 20)
+    {
+        return 1;
+    }
+
+    return 0;
+}
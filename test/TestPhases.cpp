@@ -0,0 +1,97 @@
+#include "Thread.h"
+#include "Phases.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+using namespace std;
+
+constexpr size_t taskNr = 64;
+constexpr size_t phaseNr = 200;
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 1. 每个阶段只读取上一个阶段的结果：a[i] 在每个阶段后等于阶段数
+    {
+        vector<long> cur(taskNr, 0), next(taskNr, 0);
+        vector<long> *from = &cur, *to = &next;
+        size_t betweenNr = 0;
+        atomic<bool> ordered(true);
+
+        mngr.runPhases(
+            taskNr, phaseNr,
+            [&](size_t phase, size_t i)
+            {
+                // 相邻元素在上一个阶段都应该已经完成
+                if ((*from)[(i + 1) % taskNr] != (long)phase)
+                    ordered = false;
+                (*to)[i] = (*from)[i] + 1;
+            },
+            [&](size_t phase)
+            {
+                if (phase != betweenNr++)
+                    ordered = false;
+                swap(from, to);
+            });
+
+        if (!ordered || betweenNr != phaseNr)
+        {
+            cout << "[ERROR] TestPhases: Phases overlapped." << endl;
+            return 1;
+        }
+        for (size_t i = 0; i < taskNr; i++)
+        {
+            if ((*from)[i] != (long)phaseNr)
+                return 1;
+        }
+    }
+
+    // 2. 异常在调用线程中重新抛出，之后的阶段被跳过
+    {
+        atomic<size_t> executed(0);
+        bool caught = false;
+        try
+        {
+            runPhases(mngr, taskNr, phaseNr, [&](size_t phase, size_t i)
+                      {
+                executed++;
+                if (phase == 3 && i == 7)
+                    throw runtime_error("phase failed"); });
+        }
+        catch (const runtime_error &)
+        {
+            caught = true;
+        }
+        if (!caught || executed.load() > 5 * taskNr)
+            return 1;
+    }
+
+    // 3. 在工作线程中调用，不会因为等待帮助任务而死锁
+    {
+        atomic<size_t> executed(0);
+        auto res = mngr.submit([&]
+                               { mngr.runPhases(8, 50, [&](size_t, size_t)
+                                                { executed++; }); });
+        res.get();
+        if (executed.load() != 8 * 50)
+            return 1;
+    }
+
+    // 4. 每个阶段的开销
+    {
+        constexpr size_t turn = 20000;
+        size_t workers = mngr.workerNr() + 1;
+        auto startTime = chrono::steady_clock::now();
+        mngr.runPhases(workers, turn, [](size_t, size_t) {});
+        auto endTime = chrono::steady_clock::now();
+        auto duration = chrono::duration_cast<chrono::nanoseconds>(endTime - startTime);
+        cout << "[INFO] TestPhases: Spent " << duration.count() / turn << " ns/phase with "
+             << workers << " participants." << endl;
+    }
+
+    mngr.shutdown();
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include "Thread.h"
+#include "Pipeline.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <thread>
+using namespace std;
+
+constexpr int turn = 200000;
+constexpr size_t tokens = 16;
+
+struct Record
+{
+    int id;
+    long long value;
+    string text;
+};
+
+atomic_int inPipeline, maxInPipeline, orderedRunning, summingRunning;
+atomic_bool failed;
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    int produced = 0, lastOrdered = -1;
+    long long checksum = 0;
+    size_t written = 0;
+
+    // 解析 -> 变换 -> 排序输出 -> 汇总
+    Pipeline<Record> pipeline;
+    pipeline.addStage(STAGE_PARALLEL, [](Record &r)
+                      { r.value = (long long)r.id * r.id; })
+        .addStage(STAGE_PARALLEL, [](Record &r)
+                  { r.text = to_string(r.value); })
+        .addStage(STAGE_SERIAL_IN_ORDER, [&](Record &r)
+                  {
+            if (orderedRunning.fetch_add(1) || r.id != lastOrdered + 1)
+                failed = true;
+            lastOrdered = r.id;
+            written += r.text.size();
+            orderedRunning--; })
+        .addStage(STAGE_SERIAL_OUT_OF_ORDER, [&](Record &r)
+                  {
+            if (summingRunning.fetch_add(1))
+                failed = true;
+            checksum += r.value;
+            inPipeline--;
+            summingRunning--; });
+
+    auto startTime = chrono::system_clock::now();
+    size_t nr = pipeline.run(mngr, [&](Record &r)
+                             {
+        if (produced == turn)
+            return false;
+        r.id = produced++;
+        int now = ++inPipeline;
+        if (now > maxInPipeline)
+            maxInPipeline = now;
+        return true; }, tokens);
+    auto endTime = chrono::system_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+    cout << "[INFO] TestPipeline: Spent " << ((double)duration.count() / turn) << " us/item." << endl;
+
+    long long expect = 0;
+    for (long long i = 0; i < turn; i++)
+        expect += i * i;
+    if (failed || nr != turn || lastOrdered != turn - 1 || checksum != expect ||
+        maxInPipeline > (int)tokens)
+        return 1;
+
+    // 流水线可以重复执行，阶段中的异常在 run 中重新抛出
+    produced = 0;
+    Pipeline<int> faulty;
+    faulty.addStage(STAGE_PARALLEL, [](int &x)
+                    { if (x == 100) throw runtime_error("expected"); })
+        .addStage(STAGE_SERIAL_IN_ORDER, [](int &) {});
+    for (int round = 0; round < 2; round++)
+    {
+        produced = 0;
+        try
+        {
+            faulty.run(mngr, [&](int &x)
+                       { x = produced++; return produced <= 1000; });
+            return 1;
+        }
+        catch (const runtime_error &)
+        {
+        }
+    }
+
+    // 令牌数量不变时复用上一次执行的队列和槽位，变化或者新添加的阶段重新分配
+    {
+        int last = -1;
+        long long sum = 0, extra = 0;
+        Pipeline<int> rerun;
+        rerun.addStage(STAGE_SERIAL_IN_ORDER, [&](int &x)
+                       {
+            if (x != last + 1)
+                failed = true;
+            last = x; })
+            .addStage(STAGE_SERIAL_OUT_OF_ORDER, [&](int &x)
+                      { sum += x; });
+        const size_t rounds[] = {4, 4, 8, 8, 2};
+        for (size_t round = 0; round < 5; round++)
+        {
+            if (round == 3)
+                rerun.addStage(STAGE_SERIAL_OUT_OF_ORDER, [&](int &x)
+                               { extra += x; });
+            last = -1;
+            produced = 0;
+            rerun.run(mngr, [&](int &x)
+                      { x = produced++; return produced <= 1000; }, rounds[round]);
+        }
+        if (failed || last != 999 || sum != 5 * 499500LL || extra != 2 * 499500LL)
+        {
+            cout << "[ERROR] TestPipeline: Reused pipeline lost items." << endl;
+            return 1;
+        }
+    }
+
+    // 执行中暂停线程池：数据项不再前进，也不会转到暂停它的线程上执行，恢复后继续。
+    // 只有一个令牌，暂停者离开流水线后立即产生下一个数据项并提交
+    {
+        atomic_int handled(0);
+        atomic_bool pausedOnce(false);
+        Pipeline<int> pausing;
+        pausing.addStage(STAGE_PARALLEL, [&](int &x)
+                         {
+            if (x == 10 && !pausedOnce.exchange(true))
+                mngr.pause();
+            handled++; });
+
+        int duringPause = 0, afterWait = 0;
+        thread resumer([&]
+                       {
+            while (!pausedOnce)
+                this_thread::yield();
+            this_thread::sleep_for(chrono::milliseconds(20));
+            duringPause = handled.load();
+            this_thread::sleep_for(chrono::milliseconds(20));
+            afterWait = handled.load();
+            mngr.resume(); });
+        produced = 0;
+        size_t nr = pausing.run(mngr, [&](int &x)
+                                { x = produced++; return produced <= 1000; }, 1);
+        resumer.join();
+        if (nr != 1000 || handled.load() != 1000 || duringPause == 1000 || duringPause != afterWait)
+        {
+            cout << "[ERROR] TestPipeline: " << afterWait << " item(s) handled before resume." << endl;
+            return 1;
+        }
+    }
+
+    mngr.shutdown();
+    return 0;
+}
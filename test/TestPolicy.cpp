@@ -0,0 +1,80 @@
+#include "Thread.h"
+#include "TaskGraph.h"
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 100000;
+
+atomic_int cnt;
+
+void addOne()
+{
+    cnt++;
+}
+
+// 按策略组合执行同样的任务，返回失败的数量
+template <typename _Manager>
+int runWith(const char *name)
+{
+    cnt = 0;
+    _Manager mngr(4);
+    mngr.start();
+
+    auto startTime = chrono::system_clock::now();
+    for (int i = 0; i < turn; i++)
+    {
+        mngr.submit(addOne);
+    }
+    mngr.shutdown();
+    auto endTime = chrono::system_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+
+    cout << "[INFO] TestPolicy: " << name << " spent "
+         << ((double)duration.count() / turn) << " us/task." << endl;
+    return cnt.load() != turn;
+}
+
+int main()
+{
+    int failed = 0;
+
+    failed += runWith<ThreadManager>("yield/spinLock");
+    failed += runWith<BasicThreadManager<LockFreeQueue<Task>, SpinWait, NoStats, std::mutex>>("spin/mutex");
+    // 只有主线程提交任务和改变状态，可以不加锁
+    failed += runWith<BasicThreadManager<LockFreeQueue<Task>, ParkWait, NoStats, NullLock>>("park/nullLock");
+
+    // 统计策略：每个提交的任务都恰好执行一次
+    {
+        using Manager = BasicThreadManager<LockFreeQueue<Task>, ParkWait, CountingStats>;
+        Manager mngr(4);
+        mngr.start();
+        Future<void> ret;
+        for (int i = 0; i < turn; i++)
+        {
+            ret = mngr.submit(addOne);
+        }
+        ret.get();
+        for (int i = 0; i < 100; i++)
+        {
+            mngr.submitTo(i, addOne);
+        }
+
+        // 任务图也可以运行在非默认策略的线程池上
+        TaskGraph graph;
+        TaskGraph::NodeId a = graph.addNode(addOne);
+        TaskGraph::NodeId b = graph.addNode(addOne);
+        graph.addEdge(a, b);
+        if (!graph.run(mngr))
+            failed++;
+        mngr.shutdown();
+
+        const CountingStats &stats = mngr.stats();
+        cout << "[INFO] TestPolicy: submitted " << stats.submitted() << ", executed "
+             << stats.executed() << ", idle rounds " << stats.idle() << "." << endl;
+        if (stats.submitted() != turn + 100 + 1 || stats.executed() != stats.submitted())
+            failed++;
+    }
+
+    return failed;
+}
@@ -0,0 +1,84 @@
+#include "Queue.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+using namespace std;
+
+constexpr size_t turn = 1000000;
+constexpr size_t batch = 16;
+
+/* 生产者每次写入一批数据，消费者每次读取一批数据，返回每个元素的平均耗时 */
+double transfer(Queue<size_t> &que, int producerNr, bool &correct)
+{
+    size_t perProducer = turn / producerNr;
+    vector<thread> producers;
+
+    auto startTime = chrono::steady_clock::now();
+    for (int p = 0; p < producerNr; p++)
+    {
+        producers.emplace_back([&que, perProducer]
+                               {
+            size_t elems[batch];
+            for (size_t i = 0; i < perProducer;)
+            {
+                size_t nr = min(batch, perProducer - i);
+                for (size_t k = 0; k < nr; k++)
+                    elems[k] = i + k;
+                size_t pushed = que.push(elems, nr);
+                if (!pushed)
+                    this_thread::yield();
+                i += pushed;
+            } });
+    }
+
+    size_t elems[batch];
+    size_t received = 0, sum = 0;
+    while (received < perProducer * producerNr)
+    {
+        size_t nr = que.pop(elems, batch);
+        if (!nr)
+            this_thread::yield();
+        for (size_t k = 0; k < nr; k++)
+            sum += elems[k];
+        received += nr;
+    }
+    auto endTime = chrono::steady_clock::now();
+
+    for (auto &producer : producers)
+        producer.join();
+
+    correct = sum == producerNr * (perProducer * (perProducer - 1) / 2) && que.empty();
+    return (double)chrono::duration_cast<chrono::nanoseconds>(endTime - startTime).count() /
+           (perProducer * producerNr);
+}
+
+int main()
+{
+    bool correct[5];
+
+    // 单生产者单消费者：三种队列都适用
+    LockFreeQueue<size_t> lockFree1(1024);
+    SpscQueue<size_t> spsc(1024);
+    MpscQueue<size_t> mpsc1(1024);
+    double t0 = transfer(lockFree1, 1, correct[0]);
+    double t1 = transfer(spsc, 1, correct[1]);
+    double t2 = transfer(mpsc1, 1, correct[2]);
+
+    // 多生产者单消费者：SpscQueue 不适用
+    LockFreeQueue<size_t> lockFree2(1024);
+    MpscQueue<size_t> mpsc2(1024);
+    double t3 = transfer(lockFree2, 2, correct[3]);
+    double t4 = transfer(mpsc2, 2, correct[4]);
+
+    cout << "[INFO] TestQueueBench: 1P1C LockFreeQueue " << t0 << " ns/elem, SpscQueue "
+         << t1 << " ns/elem, MpscQueue " << t2 << " ns/elem." << endl;
+    cout << "[INFO] TestQueueBench: 2P1C LockFreeQueue " << t3 << " ns/elem, MpscQueue "
+         << t4 << " ns/elem." << endl;
+
+    for (bool ok : correct)
+    {
+        if (!ok)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "Queue.h"
+#include "Task.h"
+#include <iostream>
+#include <memory>
+#include <chrono>
+using namespace std;
+
+/* 记录存活实例数量的类型，用于检查槽位只在入队时构造、出队时析构 */
+struct Tracked
+{
+    static int alive;
+    int value;
+
+    Tracked() : value(0) { alive++; }
+    explicit Tracked(int _value) : value(_value) { alive++; }
+    Tracked(const Tracked &other) : value(other.value) { alive++; }
+    Tracked &operator=(const Tracked &other) = default;
+    ~Tracked() { alive--; }
+};
+
+int Tracked::alive = 0;
+
+/* 只能移动的类型没有批量拷贝入队的虚接口 */
+template <typename _Ty>
+constexpr bool hasVirtualPush()
+{
+    return std::is_abstract<QueueCopy<_Ty>>::value;
+}
+
+static_assert(hasVirtualPush<Task>(), "copyable elements must keep the batch push");
+static_assert(!hasVirtualPush<unique_ptr<int>>(), "move-only elements must not expose push");
+
+/* 只能移动、记录存活实例数量的类型 */
+struct Owned
+{
+    static int alive;
+    unique_ptr<int> value;
+
+    Owned() { alive++; }
+    explicit Owned(int _value) : value(new int(_value)) { alive++; }
+    Owned(Owned &&other) : value(std::move(other.value)) { alive++; }
+    Owned &operator=(Owned &&other) = default;
+    ~Owned() { alive--; }
+};
+
+int Owned::alive = 0;
+
+/* 每种队列都可以存放只能移动的类型：槽位不预先构造，剩余元素在析构时析构 */
+template <typename _Queue>
+bool moveOnly()
+{
+    {
+        _Queue que(4);
+        if (Owned::alive != 0)
+            return false;
+        for (int i = 0; i < 3; i++)
+        {
+            if (!que.tryPush(Owned(i)))
+                return false;
+        }
+
+        Owned out;
+        if (!que.tryPop(out) || *out.value != 0 || que.size() != 2)
+            return false;
+        if (que.pop(&out, 1) != 1 || *out.value != 1)
+            return false;
+    }
+    return Owned::alive == 0;
+}
+
+// 只有一个消费者的队列不能作为线程池的共享队列
+static_assert(SingleConsumer<SpscQueue<Task>>::value && SingleConsumer<MpscQueue<Task>>::value &&
+                  SingleConsumer<DynamicQueue<Task, SpscQueue<Task>>>::value,
+              "single-consumer queues must be detected");
+static_assert(!SingleConsumer<LockFreeQueue<Task>>::value && !SingleConsumer<DynamicQueue<Task>>::value,
+              "multi-consumer queues must be accepted");
+
+int main()
+{
+    auto startTime = chrono::steady_clock::now();
+
+    // 1. 槽位是未初始化的内存，剩余元素在队列析构时析构
+    {
+        LockFreeQueue<Tracked> que(16);
+        if (Tracked::alive != 0)
+            return 1;
+
+        Tracked elems[10];
+        for (int i = 0; i < 10; i++)
+            elems[i].value = i;
+        if (que.push(elems, 10) != 10 || Tracked::alive != 20)
+            return 1;
+
+        Tracked out[5];
+        if (que.pop(out, 5) != 5 || out[4].value != 4 || Tracked::alive != 20)
+            return 1;
+    }
+    if (Tracked::alive != 0)
+    {
+        cout << "[ERROR] TestQueueMove: " << Tracked::alive << " element(s) leaked." << endl;
+        return 1;
+    }
+
+    // 2. 只能移动的类型，入队失败时不移动参数
+    {
+        LockFreeQueue<unique_ptr<int>> que(3);
+        if (!que.emplace(new int(1)) || !que.tryPush(unique_ptr<int>(new int(2))))
+            return 1;
+
+        unique_ptr<int> extra(new int(3));
+        if (que.tryPush(std::move(extra)) || !extra || *extra != 3)
+            return 1;
+
+        unique_ptr<int> out;
+        if (!que.tryPop(out) || *out != 1 || !que.tryPop(out) || *out != 2 || que.tryPop(out))
+            return 1;
+    }
+
+    if (!moveOnly<LockFreeQueue<Owned>>() || !moveOnly<SpscQueue<Owned>>() ||
+        !moveOnly<MpscQueue<Owned>>() || !moveOnly<DynamicQueue<Owned>>())
+    {
+        cout << "[ERROR] TestQueueMove: Move-only elements leaked or reordered." << endl;
+        return 1;
+    }
+
+    // 3. 可平凡拷贝的类型批量读写，跨越环绕点后顺序不变
+    {
+        LockFreeQueue<size_t> que(7);
+        size_t in[5], out[5];
+        size_t next = 0, expect = 0;
+        for (int round = 0; round < 1000; round++)
+        {
+            for (size_t k = 0; k < 5; k++)
+                in[k] = next + k;
+            next += que.push(in, 5);
+
+            size_t nr = que.pop(out, 5);
+            for (size_t k = 0; k < nr; k++)
+            {
+                if (out[k] != expect++)
+                {
+                    cout << "[ERROR] TestQueueMove: Out of order after wraparound." << endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // 4. 任务通过移动入队和出队
+    {
+        int called = 0;
+        LockFreeQueue<Task> que(4);
+        for (int i = 0; i < 3; i++)
+        {
+            Task task([](void *arg)
+                      { (*static_cast<int *>(arg))++; },
+                      &called);
+            if (!que.tryPush(std::move(task)))
+                return 1;
+        }
+        Task task;
+        while (que.tryPop(task))
+            task();
+        if (called != 3)
+            return 1;
+    }
+
+    auto endTime = chrono::steady_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+    cout << "[INFO] TestQueueMove: Spent " << duration.count() << " us." << endl;
+    return 0;
+}
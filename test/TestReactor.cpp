@@ -0,0 +1,136 @@
+#include "Thread.h"
+#include "Reactor.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int pipeNr = 8;
+constexpr int turn = 2000;
+
+struct Completion
+{
+    int pipe;
+    int bytes;
+};
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 回调引用了完成队列，事件循环需要先于完成队列析构
+    CompletionQueue<Completion> completions(pipeNr * turn);
+    Reactor reactor(mngr);
+    if (!reactor.valid() || !completions.valid())
+        return 1;
+
+    // 每个管道的读端注册到内置的事件循环，回调在线程池中读取数据并将结果送回
+    int fds[pipeNr][2];
+    atomic_int running[pipeNr];
+    atomic_bool overlapped(false);
+    for (int p = 0; p < pipeNr; p++)
+    {
+        if (pipe(fds[p]))
+            return 1;
+        running[p] = 0;
+        reactor.add(fds[p][0], EPOLLIN, [&, p](int fd, uint32_t)
+                    {
+            if (running[p].fetch_add(1))
+                overlapped = true;
+            char buf[256];
+            ssize_t nr = read(fd, buf, sizeof(buf));
+            if (nr > 0)
+                completions.post(Completion{p, (int)nr});
+            running[p]--; });
+    }
+    if (reactor.size() != pipeNr || reactor.add(fds[0][0], EPOLLIN, [](int, uint32_t) {}))
+        return 1;
+
+    // 外部的事件循环只监听完成通知
+    int loop = epoll_create1(0);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = completions.fd();
+    epoll_ctl(loop, EPOLL_CTL_ADD, completions.fd(), &ev);
+
+    auto startTime = chrono::system_clock::now();
+    thread writer([&]
+                  {
+        for (int i = 0; i < turn; i++)
+            for (int p = 0; p < pipeNr; p++)
+                if (write(fds[p][1], "x", 1) != 1)
+                    overlapped = true; });
+
+    int received = 0, wakeups = 0;
+    int perPipe[pipeNr] = {0};
+    while (received < pipeNr * turn)
+    {
+        struct epoll_event ready;
+        if (epoll_wait(loop, &ready, 1, 5000) <= 0)
+            break;
+        wakeups++;
+        completions.drain([&](const Completion &c)
+                          {
+            perPipe[c.pipe] += c.bytes;
+            received += c.bytes; });
+    }
+    writer.join();
+    auto endTime = chrono::system_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+    cout << "[INFO] TestReactor: Spent " << ((double)duration.count() / (pipeNr * turn))
+         << " us/byte with " << wakeups << " wakeup(s)." << endl;
+
+    // 移除之后不会再执行回调
+    atomic_int late(0);
+    reactor.remove(fds[0][0]);
+    if (reactor.remove(fds[0][0]))
+        return 1;
+    EventNotifier notifier;
+    reactor.add(notifier.fd(), EPOLLIN, [&](int, uint32_t)
+                { late += notifier.consume(); });
+    notifier.notify(3);
+    if (write(fds[0][1], "y", 1) != 1)
+        return 1;
+    for (int i = 0; i < 500 && late.load() != 3; i++)
+        this_thread::sleep_for(chrono::milliseconds(1));
+
+    // 线程池暂停时回调被推迟，不在事件循环中执行，恢复后才执行
+    atomic_int deferred(0);
+    EventNotifier pausedNotifier;
+    reactor.add(pausedNotifier.fd(), EPOLLIN, [&](int, uint32_t)
+                { deferred += pausedNotifier.consume(); });
+    mngr.pause();
+    pausedNotifier.notify(2);
+    this_thread::sleep_for(chrono::milliseconds(20));
+    if (deferred.load())
+    {
+        cout << "[ERROR] TestReactor: Callback ran while the pool was paused." << endl;
+        return 1;
+    }
+    mngr.resume();
+    for (int i = 0; i < 500 && deferred.load() != 2; i++)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    reactor.remove(pausedNotifier.fd());
+    if (deferred.load() != 2)
+        return 1;
+
+    close(loop);
+    for (int p = 0; p < pipeNr; p++)
+    {
+        reactor.remove(fds[p][0]);
+        close(fds[p][0]);
+        close(fds[p][1]);
+    }
+    reactor.remove(notifier.fd());
+
+    if (overlapped || received != pipeNr * turn || late.load() != 3)
+        return 1;
+    for (int p = 0; p < pipeNr; p++)
+    {
+        if (perPipe[p] != turn)
+            return 1;
+    }
+    return 0;
+}
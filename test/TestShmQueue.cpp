@@ -0,0 +1,232 @@
+#include "Thread.h"
+#include "ShmQueue.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <iostream>
+#include <string>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 20000;
+
+struct Message
+{
+    int producer;
+    int seq;
+    long value;
+};
+
+/* 子进程：按顺序写入 turn 条消息，队列满时让出 CPU */
+void produce(ShmQueue<Message> &que, int producer)
+{
+    for (int i = 0; i < turn;)
+    {
+        Message msg = {producer, i, (long)i};
+        if (que.tryPush(msg))
+            i++;
+        else
+            this_thread::yield();
+    }
+}
+
+int main()
+{
+    auto startTime = chrono::steady_clock::now();
+
+    // 1. 同一进程中的两个映射：地址不同，内容相同
+    {
+        ShmQueue<Message> que, other;
+        if (!que.create(1000) || que.capacity() != 1024 || !other.attach(que.fd()))
+            return 1;
+
+        for (int i = 0; i < 1024; i++)
+        {
+            Message msg = {0, i, (long)i};
+            if (!que.tryPush(msg))
+                return 1;
+        }
+        Message msg = {0, 0, 0};
+        if (que.tryPush(msg))
+            return 1;
+
+        for (int i = 0; i < 1024; i++)
+        {
+            if (!other.tryPop(msg) || msg.seq != i)
+                return 1;
+        }
+        if (other.tryPop(msg) || !que.empty())
+            return 1;
+
+        // 消息类型的布局不一致时拒绝映射
+        ShmQueue<long> wrong;
+        if (wrong.attach(que.fd()))
+            return 1;
+
+        // 头部的容量（magic 和 elemSize 之后）被改坏时拒绝映射：
+        // 为 0、不是 2 的幂、乘以槽位大小后溢出
+        uint64_t saved;
+        if (pread(que.fd(), &saved, sizeof(saved), 8) != sizeof(saved) || saved != 1024)
+            return 1;
+        for (uint64_t bad : {(uint64_t)0, (uint64_t)1000, (uint64_t)1 << 62, (uint64_t)2048})
+        {
+            ShmQueue<Message> broken;
+            if (pwrite(que.fd(), &bad, sizeof(bad), 8) != sizeof(bad) || broken.attach(que.fd()))
+                return 1;
+        }
+        ShmQueue<Message> restored;
+        if (pwrite(que.fd(), &saved, sizeof(saved), 8) != sizeof(saved) || !restored.attach(que.fd()))
+            return 1;
+    }
+
+    // 2. 按名字创建和打开
+    {
+        string name = "/thread_pool_test_" + to_string(getpid());
+        ShmQueue<Message> que, other;
+        if (!que.create(16, name.c_str()) || !other.open(name.c_str()))
+            return 1;
+        ShmRegion::unlink(name.c_str());
+
+        Message msg = {1, 2, 3};
+        if (!other.tryPush(msg) || !que.tryPop(msg) || msg.value != 3)
+            return 1;
+    }
+
+    // 取整或者计算大小会溢出的容量直接失败
+    {
+        ShmQueue<Message> que;
+        if (que.create(SIZE_MAX) || que.create(((size_t)1 << 63) + 1) ||
+            que.create(SIZE_MAX / sizeof(Message)))
+        {
+            cout << "[ERROR] TestShmQueue: Oversized capacity accepted." << endl;
+            return 1;
+        }
+    }
+
+    // 3. 两个子进程写入，线程池处理；子进程必须在创建线程之前 fork
+    {
+        ShmQueue<Message> que;
+        if (!que.create(256))
+            return 1;
+
+        pid_t children[2];
+        for (int p = 0; p < 2; p++)
+        {
+            children[p] = fork();
+            if (children[p] == 0)
+            {
+                // 第二个子进程通过文件描述符重新映射
+                ShmQueue<Message> attached;
+                if (p == 1 && !attached.attach(que.fd()))
+                    _exit(1);
+                produce(p == 1 ? attached : que, p);
+                _exit(0);
+            }
+        }
+
+        atomic<long> sum(0);
+        atomic<int> received(0);
+        {
+            ThreadManager mngr(4);
+            mngr.start();
+            ShmIngress<Message> ingress(mngr, que, [&](const Message &msg)
+                                        {
+                sum += msg.value;
+                received++; });
+
+            auto deadline = chrono::steady_clock::now() + chrono::seconds(30);
+            while (received.load() < 2 * turn && chrono::steady_clock::now() < deadline)
+            {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+
+        for (int p = 0; p < 2; p++)
+        {
+            int status = 0;
+            waitpid(children[p], &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                return 1;
+        }
+        long expect = 2L * turn * (turn - 1) / 2;
+        if (received.load() != 2 * turn || sum.load() != expect)
+        {
+            cout << "[ERROR] TestShmQueue: Received " << received.load() << " of " << 2 * turn
+                 << " messages, sum " << sum.load() << " of " << expect << "." << endl;
+            return 1;
+        }
+    }
+
+    // 4. 线程池暂停时批次被推迟，不在接收线程中处理，恢复后才处理
+    {
+        ShmQueue<Message> que;
+        if (!que.create(64))
+            return 1;
+        ThreadManager mngr(2);
+        mngr.start();
+        atomic<int> handled(0);
+        ShmIngress<Message> ingress(mngr, que, [&](const Message &)
+                                    { handled++; });
+
+        mngr.pause();
+        for (int i = 0; i < 10; i++)
+        {
+            Message msg = {0, i, (long)i};
+            if (!que.tryPush(msg))
+                return 1;
+        }
+        while (ingress.received() != 10)
+            this_thread::yield();
+        this_thread::sleep_for(chrono::milliseconds(20));
+        if (handled.load())
+        {
+            cout << "[ERROR] TestShmQueue: Messages handled while the pool was paused." << endl;
+            return 1;
+        }
+        mngr.resume();
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+        while (handled.load() != 10 && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        if (handled.load() != 10)
+            return 1;
+    }
+
+    // 5. 批次全部在途时接收线程不再取出消息，剩余的留在共享内存中
+    {
+        constexpr int total = 2000;
+        constexpr size_t bound = ShmIngress<Message>::INGRESS_BATCHES * ShmIngress<Message>::INGRESS_BATCH;
+        ShmQueue<Message> que;
+        if (!que.create(total))
+            return 1;
+        ThreadManager mngr(2);
+        mngr.start();
+        atomic<int> handled(0);
+        ShmIngress<Message> ingress(mngr, que, [&](const Message &)
+                                    { handled++; });
+
+        mngr.pause();
+        for (int i = 0; i < total; i++)
+        {
+            Message msg = {0, i, (long)i};
+            if (!que.tryPush(msg))
+                return 1;
+        }
+        this_thread::sleep_for(chrono::milliseconds(50));
+        if (!ingress.received() || ingress.received() > bound)
+        {
+            cout << "[ERROR] TestShmQueue: " << ingress.received()
+                 << " messages pulled while the pool was paused." << endl;
+            return 1;
+        }
+        mngr.resume();
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+        while (handled.load() != total && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        if (handled.load() != total)
+            return 1;
+    }
+
+    auto endTime = chrono::steady_clock::now();
+    auto duration = chrono::duration_cast<chrono::milliseconds>(endTime - startTime);
+    cout << "[INFO] TestShmQueue: Spent " << duration.count() << " ms." << endl;
+    return 0;
+}
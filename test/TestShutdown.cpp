@@ -0,0 +1,81 @@
+#include "Thread.h"
+#include <unistd.h>
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+constexpr int turn = 200;
+
+atomic_int cnt;
+
+void sleepTask()
+{
+    this_thread::sleep_for(chrono::milliseconds(1));
+    cnt++;
+}
+
+int main()
+{
+    // 1. shutdown 需要等待队列排空并且正在执行的任务全部完成
+    {
+        ThreadManager mngr(4);
+        mngr.start();
+        for (int i = 0; i < turn; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+
+        auto startTime = chrono::steady_clock::now();
+        mngr.shutdown();
+        auto endTime = chrono::steady_clock::now();
+        auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+
+        cout << "[INFO] TestShutdown: Drained in " << duration.count() << " us." << endl;
+        if (cnt.load() != turn)
+        {
+            cout << "[ERROR] TestShutdown: " << cnt.load() << " of " << turn << " tasks finished." << endl;
+            return 1;
+        }
+    }
+
+    // 2. shutdownFor 超时后报告剩余的任务
+    {
+        cnt = 0;
+        ThreadManager mngr(2);
+        mngr.start();
+        for (int i = 0; i < turn; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+
+        ShutdownReport report = mngr.shutdownFor(chrono::milliseconds(10));
+        cout << "[INFO] TestShutdown: drained=" << report.drained
+             << ", queued=" << report.queued
+             << ", running=" << report.running
+             << ", finished=" << cnt.load() << endl;
+        if (report.drained || report.queued == 0 ||
+            cnt.load() + report.queued != turn)
+        {
+            return 1;
+        }
+    }
+
+    // 3. 限时足够时，shutdownFor 正常排空
+    {
+        cnt = 0;
+        ThreadManager mngr(4);
+        mngr.start();
+        for (int i = 0; i < 20; i++)
+        {
+            mngr.submit(sleepTask);
+        }
+
+        ShutdownReport report = mngr.shutdownFor(chrono::seconds(10));
+        if (!report.drained || cnt.load() != 20)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "Thread.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+using namespace std;
+
+constexpr int turn = 100000;
+constexpr int keyNr = 16;
+
+// 只被同一个键的任务访问，不加锁
+int lastSeen[keyNr];
+int counter[keyNr];
+atomic_int running;
+atomic_bool overlapped, disordered;
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 同一个 Strand 中的任务按顺序执行，并且不会并发
+    Strand *strand = mngr.strand();
+    int last = -1;
+    Future<void> ret;
+    for (int i = 0; i < turn; i++)
+    {
+        ret = strand->submit([&, i]
+                             {
+            if (running.fetch_add(1) != 0)
+                overlapped = true;
+            if (last != i - 1)
+                disordered = true;
+            last = i;
+            running--; });
+    }
+    ret.get();
+
+    // 按键提交，每个键的计数不加锁也不会丢失
+    auto startTime = chrono::system_clock::now();
+    for (int i = 0; i < keyNr; i++)
+    {
+        lastSeen[i] = -1;
+    }
+    for (int i = 0; i < turn; i++)
+    {
+        int key = i % keyNr;
+        mngr.submitKeyed(string("session-") + to_string(key), [key, i]
+                         {
+            if (lastSeen[key] >= i)
+                disordered = true;
+            lastSeen[key] = i;
+            counter[key]++; });
+    }
+    mngr.shutdown();
+    auto endTime = chrono::system_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+    cout << "[INFO] TestStrand: Spent " << ((double)duration.count() / turn) << " us/task." << endl;
+
+    if (overlapped || disordered || last != turn - 1)
+        return 1;
+    for (int i = 0; i < keyNr; i++)
+    {
+        if (counter[i] != turn / keyNr)
+            return 1;
+    }
+
+    // 暂停或尚未启动的线程池不执行 Strand 的任务，也不转到提交者的线程上执行，
+    // 恢复运行后继续；线程池终止后才由提交者直接执行
+    {
+        ThreadManager paused(2);
+        Strand *early = paused.strand();
+        thread::id caller = this_thread::get_id();
+        atomic_int ran(0);
+        atomic_bool onCaller(false);
+        auto task = [&]
+        {
+            if (this_thread::get_id() == caller)
+                onCaller = true;
+            ran++;
+        };
+
+        early->submit(task);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        if (ran.load())
+            return 1;
+        paused.start();
+        while (ran.load() != 1)
+            this_thread::yield();
+
+        paused.pause();
+        Future<void> last;
+        for (int i = 0; i < 10; i++)
+            last = early->submit(task);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        if (ran.load() != 1 || onCaller)
+        {
+            cout << "[ERROR] TestStrand: Strand ran while the pool was paused." << endl;
+            return 1;
+        }
+        paused.resume();
+        last.get();
+        if (ran.load() != 11 || onCaller)
+            return 1;
+
+        paused.shutdown();
+        early->submit(task).get();
+        if (ran.load() != 12 || !onCaller)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "Thread.h"
+#include "TaskGraph.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+using namespace std;
+
+constexpr int turn = 1000;
+constexpr int width = 8;
+
+atomic_int cnt;
+atomic_int stamp;
+int order[2 + width];
+
+int main()
+{
+    ThreadManager mngr(4);
+    mngr.start();
+
+    // 菱形任务图：source -> width 个中间节点 -> sink
+    TaskGraph graph;
+    TaskGraph::NodeId source = graph.addNode([]
+                                             { order[0] = stamp++; cnt++; });
+    TaskGraph::NodeId sink = graph.addNode([]
+                                           { order[1] = stamp++; cnt++; });
+    for (int i = 0; i < width; i++)
+    {
+        TaskGraph::NodeId mid = graph.addNode([i]
+                                              { order[2 + i] = stamp++; cnt++; });
+        graph.addEdge(source, mid);
+        graph.addEdge(mid, sink);
+    }
+
+    long long costTime = 0LL;
+    for (int i = 0; i < turn; i++)
+    {
+        stamp = 0;
+        auto startTime = chrono::steady_clock::now();
+
+        if (!graph.run(mngr))
+            return 1;
+
+        auto endTime = chrono::steady_clock::now();
+        costTime += chrono::duration_cast<chrono::microseconds>(endTime - startTime).count();
+
+        // 源节点必须最先执行，汇节点必须最后执行
+        if (order[0] != 0 || order[1] != width + 1)
+        {
+            cout << "[ERROR] TestTaskGraph: Dependency violated in run " << i << "." << endl;
+            return 1;
+        }
+    }
+
+    // 存在环的图不能执行
+    TaskGraph cycle;
+    TaskGraph::NodeId a = cycle.addNode([] {});
+    TaskGraph::NodeId b = cycle.addNode([] {});
+    cycle.addEdge(a, b);
+    cycle.addEdge(b, a);
+    if (cycle.run(mngr))
+        return 1;
+
+    // 执行中暂停线程池：完成源节点的线程只接着执行一个后继，其余后继等到恢复后才执行
+    {
+        atomic_int midNr(0);
+        atomic_bool sourceDone(false);
+        TaskGraph paused;
+        TaskGraph::NodeId head = paused.addNode([&]
+                                                { mngr.pause(); sourceDone = true; });
+        for (int i = 0; i < width; i++)
+            paused.addEdge(head, paused.addNode([&]
+                                                { midNr++; }));
+
+        int duringPause = -1;
+        thread resumer([&]
+                       {
+            while (!sourceDone)
+                this_thread::yield();
+            this_thread::sleep_for(chrono::milliseconds(20));
+            duringPause = midNr.load();
+            mngr.resume(); });
+        bool ran = paused.run(mngr);
+        resumer.join();
+        if (!ran || duringPause != 1 || midNr.load() != width)
+        {
+            cout << "[ERROR] TestTaskGraph: " << duringPause << " node(s) ran while paused." << endl;
+            return 1;
+        }
+    }
+
+    mngr.shutdown();
+
+    cout << "[INFO] TestTaskGraph: Spent " << ((double)costTime / turn) << " us/run." << endl;
+
+    return cnt.load() - turn * (2 + width);
+}
@@ -0,0 +1,128 @@
+#include "Thread.h"
+#include "Trace.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+using namespace std;
+
+constexpr int turn = 250;
+
+/* 析构时计数的任务，用于检查被丢弃的任务是否释放 */
+struct Probe
+{
+    int *released;
+
+    Probe(int *_released) : released(_released) {}
+    Probe(Probe &&other) : released(other.released) { other.released = nullptr; }
+    ~Probe()
+    {
+        if (released)
+            (*released)++;
+    }
+
+    bool valid() const { return released != nullptr; }
+    void operator()() {}
+};
+
+int main()
+{
+    string path = "/tmp/TestTrace." + to_string(getpid()) + ".trace";
+    BusyWork work;
+
+    // 1. 采集两个线程提交的任务，保存后重新读取
+    {
+        TraceRecorder recorder;
+        ThreadManager mngr(4);
+        mngr.start();
+        mngr.setTrace(&recorder);
+
+        auto producer = [&]
+        {
+            for (int i = 0; i < turn; i++)
+            {
+                mngr.submit([&]
+                            { work.run(20000); });
+                this_thread::sleep_for(chrono::microseconds(50));
+            }
+        };
+        thread first(producer), second(producer);
+        first.join();
+        second.join();
+        mngr.setTrace(nullptr);
+        mngr.shutdown();
+
+        if (recorder.size() != 2 * turn || recorder.dropped())
+        {
+            cout << "[ERROR] TestTrace: Recorded " << recorder.size() << " tasks." << endl;
+            return 1;
+        }
+        if (!recorder.save(path.c_str()))
+            return 1;
+    }
+
+    vector<TraceRecord> records;
+    if (!loadTrace(path.c_str(), records) || records.size() != 2 * turn)
+        return 1;
+    unlink(path.c_str());
+
+    size_t threads[2] = {records[0].thread, records[0].thread};
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (i && records[i].submit < records[i - 1].submit)
+            return 1;
+        if (records[i].duration < 10000)
+        {
+            cout << "[ERROR] TestTrace: Task lasted only " << records[i].duration << " ns." << endl;
+            return 1;
+        }
+        if (records[i].thread != threads[0])
+            threads[1] = records[i].thread;
+    }
+    if (threads[0] == threads[1])
+        return 1;
+
+    // 2. 记录满后丢弃之后的任务
+    {
+        TraceRecorder recorder(10);
+        for (int i = 0; i < 20; i++)
+            recorder.wrap(Task([](void *) {}, nullptr))();
+        if (recorder.size() != 10 || recorder.dropped() != 10)
+            return 1;
+    }
+
+    // 3. 包装后的任务持有原任务，没有执行就被丢弃时一起释放
+    {
+        TraceRecorder recorder;
+        int released = 0;
+        {
+            Task task = recorder.wrap(Task(Probe{&released}));
+        }
+        ThreadManager stopped(2);
+        stopped.setTrace(&recorder);
+        stopped.trySubmit([]
+                          { return 0; });
+        if (released != 1 || recorder.size())
+            return 1;
+    }
+
+    // 4. 在另一个配置上重放
+    ThreadManager mngr(2, 64);
+    mngr.start();
+    ReplayReport report = replayTrace(mngr, records, work, 2.0);
+    mngr.shutdown();
+
+    if (report.tasks != records.size() || report.dropped ||
+        report.delayP50 > report.delayP90 || report.delayP90 > report.delayP99 ||
+        report.delayP99 > report.delayMax || report.cpuSeconds <= 0)
+    {
+        cout << "[ERROR] TestTrace: Replay report is inconsistent." << endl;
+        return 1;
+    }
+
+    cout << "[INFO] TestTrace: Replayed " << report.tasks << " tasks in " << report.seconds * 1000
+         << " ms, delay p50 " << report.delayP50 / 1000 << " us, p99 " << report.delayP99 / 1000
+         << " us, cpu " << report.cpuSeconds * 1000 << " ms." << endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "Thread.h"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+using namespace std;
+
+constexpr int turn = 100000;
+constexpr size_t scratchSize = 1024;
+
+// 每个工作线程一份，不需要加锁
+struct Counter
+{
+    long long tasks = 0;
+    long long sum = 0;
+    size_t arenaMax = 0;
+};
+
+int main()
+{
+    int failed = 0;
+
+    // Arena：对齐、复用和超过块大小的分配
+    {
+        Arena arena(4096);
+        char *first = static_cast<char *>(arena.allocate(1, 1));
+        double *aligned = arena.allocateArray<double>(3);
+        if (reinterpret_cast<uintptr_t>(aligned) % alignof(double))
+            failed++;
+        void *large = arena.allocate(10000);
+        memset(large, 0, 10000);
+        arena.reset();
+        if (arena.allocate(1, 1) != first)
+            failed++;
+        size_t capacity = arena.capacity();
+        arena.allocate(10000);
+        if (arena.capacity() != capacity)
+            failed++;
+        arena.release();
+        if (arena.capacity() != 0)
+            failed++;
+    }
+
+    ThreadManager mngr(4);
+    mngr.start();
+
+    auto startTime = chrono::system_clock::now();
+    for (int i = 0; i < turn; i++)
+    {
+        mngr.submit([&mngr, i]
+                    {
+            size_t index = mngr.workerIndex();
+            Counter &counter = mngr.workerLocal<Counter>(index);
+
+            // 临时缓冲区来自 Arena，任务结束后自动回收
+            Arena &arena = mngr.workerArena();
+            int *scratch = arena.allocateArray<int>(scratchSize);
+            for (size_t k = 0; k < scratchSize; k++)
+                scratch[k] = i;
+            counter.tasks++;
+            counter.sum += scratch[scratchSize - 1];
+            counter.arenaMax = max(counter.arenaMax, arena.capacity()); });
+    }
+    mngr.shutdown();
+    auto endTime = chrono::system_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
+    cout << "[INFO] TestWorkerLocal: Spent " << ((double)duration.count() / turn) << " us/task." << endl;
+
+    // 线程池空闲后汇总各个工作线程的对象
+    long long tasks = 0, sum = 0;
+    for (size_t w = 0; w < mngr.workerSlotNr(); w++)
+    {
+        Counter *counter = mngr.findWorkerLocal<Counter>(w);
+        if (!counter)
+            continue;
+        tasks += counter->tasks;
+        sum += counter->sum;
+        // 每个任务结束后 Arena 都被重置，始终只需要一个块
+        if (counter->arenaMax != ARENA_BLOCK_SIZE)
+            failed++;
+    }
+    if (tasks != turn || sum != (long long)turn * (turn - 1) / 2)
+        failed++;
+
+    // 非工作线程拿到的是自己的对象
+    if (mngr.workerIndex() != ThreadManager::WORKER_NONE || mngr.workerLocal<Counter>().tasks != 0)
+        failed++;
+
+    return failed;
+}
@@ -0,0 +1,110 @@
+/**
+ * 按照 TraceRecorder 保存的负载，在指定配置的线程池上重放任务并输出报告。
+ *
+ * 用法：trace_replay <trace> [poolSize] [queueSize] [speed] [name=value ...]
+ * - poolSize：工作线程数量，默认 10；
+ * - queueSize：共享队列容量，默认 1000；
+ * - speed：到达速度的倍数，大于 1 时按更快的速度提交，默认 1。
+ * 之后的 name=value 对应 PoolOptions 中的字段，未指定时使用 PoolOptions 的默认值：
+ * - handoff=0|1：是否把任务直接交付给空闲的工作线程；
+ * - idleTrim=<ms>：空闲多少毫秒后回收内存，0 表示不回收；
+ * - stackSize=<bytes>、guardSize=<bytes>：工作线程的栈大小和保护页大小。
+ * 队列、等待、统计和锁策略是模板参数，固定为 ThreadManager 的默认组合，
+ * 比较其他策略需要用对应的 BasicThreadManager 重新编译本工具。
+ */
+#include "Thread.h"
+#include "Trace.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+/* 解析一个 name=value 选项，名字未知或者值不合法时返回 false */
+static bool parseOption(const char *arg, PoolOptions &options)
+{
+    const char *eq = strchr(arg, '=');
+    char *end = nullptr;
+    unsigned long long value = strtoull(eq + 1, &end, 10);
+    if (end == eq + 1 || *end)
+        return false;
+
+    string name(arg, eq - arg);
+    if (name == "handoff" && value <= 1)
+        options.handoff = value;
+    else if (name == "idleTrim")
+        options.idleTrim = chrono::milliseconds(value);
+    else if (name == "stackSize")
+        options.stackSize = value;
+    else if (name == "guardSize")
+        options.guardSize = value;
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: " << argv[0] << " <trace> [poolSize] [queueSize] [speed]"
+             << " [handoff=0|1] [idleTrim=ms] [stackSize=bytes] [guardSize=bytes]" << endl;
+        return 1;
+    }
+
+    // 前面的参数按位置解析，带 '=' 的参数是 PoolOptions 的字段
+    const char *positional[3] = {nullptr, nullptr, nullptr};
+    size_t positionalNr = 0;
+    PoolOptions options;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strchr(argv[i], '='))
+        {
+            if (!parseOption(argv[i], options))
+            {
+                cerr << "Invalid option '" << argv[i] << "'." << endl;
+                return 1;
+            }
+        }
+        else if (positionalNr < 3)
+        {
+            positional[positionalNr++] = argv[i];
+        }
+        else
+        {
+            cerr << "Unexpected argument '" << argv[i] << "'." << endl;
+            return 1;
+        }
+    }
+
+    size_t poolSize = positional[0] ? strtoul(positional[0], nullptr, 10) : 10;
+    size_t queueSize = positional[1] ? strtoul(positional[1], nullptr, 10) : 1000;
+    double speed = positional[2] ? atof(positional[2]) : 1.0;
+    if (!poolSize || !queueSize || speed <= 0)
+    {
+        cerr << "Invalid pool size, queue size or speed." << endl;
+        return 1;
+    }
+
+    vector<TraceRecord> records;
+    if (!loadTrace(argv[1], records))
+    {
+        cerr << "Failed to load trace '" << argv[1] << "'." << endl;
+        return 1;
+    }
+
+    BusyWork work;
+    ThreadManager mngr(poolSize, queueSize, options);
+    mngr.start();
+    ReplayReport report = replayTrace(mngr, records, work, speed);
+    mngr.shutdown();
+
+    cout << "tasks:       " << report.tasks << " (" << report.dropped << " dropped)" << endl
+         << "elapsed:     " << report.seconds << " s" << endl
+         << "throughput:  " << report.throughput << " tasks/s" << endl
+         << "delay p50:   " << report.delayP50 / 1000.0 << " us" << endl
+         << "delay p90:   " << report.delayP90 / 1000.0 << " us" << endl
+         << "delay p99:   " << report.delayP99 / 1000.0 << " us" << endl
+         << "delay max:   " << report.delayMax / 1000.0 << " us" << endl
+         << "cpu:         " << report.cpuSeconds << " s" << endl;
+    return 0;
+}